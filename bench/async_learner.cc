@@ -0,0 +1,56 @@
+#include <torch_agents.h>
+
+#include <chrono>
+#include <iostream>
+
+// Acting throughput (environment steps per second) of the torch linear agent
+// with training inline versus on a dedicated learner thread, for a few
+// snapshot publish intervals, plus the learner without its cap of one
+// minibatch per transition.
+
+constexpr int kFeatures = 16;
+constexpr int kActions = 4;
+constexpr int kSteps = 20000;
+
+using Agent = RLlib::OffPolicyLinearSarsaAgent<kFeatures, kActions, int>;
+
+double StepsPerSecond(const json &model_config) {
+  json config = {{"epsilon", 0.1},
+                 {"gamma", 0.9},
+                 {"training_mode", "q_learning"},
+                 {"model", model_config}};
+  Agent agent(Agent::ActionsList{0, 1, 2, 3}, config);
+
+  Agent::State state{};
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step < kSteps; ++step) {
+    for (auto &s : state) s = rng_util::uniform01();
+    auto action = agent.UpdateState(state);
+    agent.CollectReward(action == step % kActions ? 1.0 : 0.0);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return kSteps / std::chrono::duration<double>(end - start).count();
+}
+
+int main() {
+  json model_config = {{"weights", 0.0},
+                       {"learning_rate", 1e-3},
+                       {"replay_capacity", 100000},
+                       {"batch_size", 64},
+                       {"optimizer", {{"type", "sgd"}}}};
+  std::cout << "mode\tpublish_interval\tsteps_per_sec" << std::endl;
+  std::cout << "sync\t-\t" << StepsPerSecond(model_config) << std::endl;
+  for (int publish_interval : {1, 10, 100, 1000}) {
+    json async_config = model_config;
+    async_config["async_learner"] = true;
+    async_config["publish_interval"] = publish_interval;
+    std::cout << "async\t" << publish_interval << "\t"
+              << StepsPerSecond(async_config) << std::endl;
+  }
+  json uncapped_config = model_config;
+  uncapped_config["async_learner"] = true;
+  uncapped_config["updates_per_transition"] = 0;
+  std::cout << "async_uncapped\t100\t" << StepsPerSecond(uncapped_config)
+            << std::endl;
+  return 0;
+}
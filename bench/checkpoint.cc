@@ -0,0 +1,48 @@
+#include <models/tabular.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+
+// Save/load time of a 1M-entry Tabular model: text OutputModel/LoadModel
+// against the binary checkpoint.
+
+constexpr int kStates = 250000;
+constexpr int kActions = 4;
+
+using Table = RLlib::Models::Tabular<kStates, kActions>;
+
+template <typename TFunc>
+double Millis(TFunc &&func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+  // ~8 MB of values: keep them off the stack
+  auto table = std::make_unique<Table>(json{{"action_values", 0.0}});
+  for (int s = 0; s < kStates; ++s) {
+    for (int a = 0; a < kActions; ++a) {
+      table->Update(s, a, rng_util::normal());
+    }
+  }
+  auto loaded = std::make_unique<Table>(json{{"action_values", 0.0}});
+
+  std::cout << "format\tsave_ms\tload_ms" << std::endl;
+  double text_save = Millis([&]() { table->OutputModel("bench_table.txt"); });
+  double text_load = Millis([&]() { loaded->LoadModel("bench_table.txt"); });
+  std::cout << "text\t" << text_save << "\t" << text_load << std::endl;
+
+  double bin_save =
+      Millis([&]() { table->SaveCheckpoint("bench_table.ckpt"); });
+  double bin_load =
+      Millis([&]() { loaded->LoadCheckpoint("bench_table.ckpt"); });
+  std::cout << "binary\t" << bin_save << "\t" << bin_load << std::endl;
+
+  std::remove("bench_table.txt");
+  std::remove("bench_table.ckpt");
+  return 0;
+}
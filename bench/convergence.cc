@@ -0,0 +1,111 @@
+#include <linear_agents.h>
+#include <tabular_agents.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "grid_env.h"
+
+// Convergence speed of the training modes on the 5x6 grid: steps until the
+// moving average reward over `window` steps first reaches `fraction` of the
+// best achievable average reward (the maximum mean cycle of the torus, by
+// Karp's algorithm). Each mode runs with seeds 0 .. runs - 1; runs that do not
+// get there within max_steps count as misses.
+//
+// usage: bench_convergence <grid|grid_linear> <config.json> [max_steps]
+//                          [runs] [fraction] [window]
+
+// Steps to reach the threshold, or -1.
+template <typename TAgent>
+long StepsToThreshold(const json &config,
+                      const std::array<double, nstates> &values,
+                      long max_steps, double threshold, int window) {
+  TAgent agent(kMoves, config);
+  std::vector<double> recent(window, 0.0);
+  double sum = 0.0;
+  Position pos{0, 0};
+  for (long step = 0; step < max_steps; ++step) {
+    pos = Move(pos, agent.UpdateState(Observe<TAgent>(pos)));
+    const double reward = values[pos[0] * ncols + pos[1]];
+    agent.CollectReward(reward);
+    auto &slot = recent[step % window];
+    sum += reward - slot;
+    slot = reward;
+    if (step + 1 >= window && sum >= threshold * window) return step + 1;
+  }
+  return -1;
+}
+
+template <typename TAgent>
+void Compare(json config, const std::array<double, nstates> &values,
+             long max_steps, int runs, double threshold, int window) {
+  std::cout << "mode\treached\tmedian_steps\tmean_steps" << std::endl;
+  for (const char *mode : RLlib::SarsaTrainingModeNames) {
+    config["training_mode"] = mode;
+    std::vector<long> steps;
+    try {
+      for (int run = 0; run < runs; ++run) {
+        config["seed"] = run;
+        const long n = StepsToThreshold<TAgent>(config, values, max_steps,
+                                                threshold, window);
+        if (n >= 0) steps.push_back(n);
+      }
+    } catch (const std::runtime_error &e) {
+      // e.g. a mode the configured model does not support
+      std::cout << mode << "\tskipped: " << e.what() << std::endl;
+      continue;
+    }
+    std::cout << mode << "\t" << steps.size() << "/" << runs << "\t";
+    if (steps.empty()) {
+      std::cout << "-\t-" << std::endl;
+      continue;
+    }
+    std::sort(steps.begin(), steps.end());
+    double mean = 0.0;
+    for (long n : steps) mean += static_cast<double>(n) / steps.size();
+    std::cout << steps[steps.size() / 2] << "\t" << std::fixed
+              << std::setprecision(0) << mean << std::defaultfloat
+              << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0]
+              << " <grid|grid_linear> <config.json> [max_steps] [runs]"
+                 " [fraction] [window]"
+              << std::endl;
+    return 1;
+  }
+  const std::string agent = argv[1];
+  json config = RLlib::load_json(argv[2]);
+  const long max_steps =
+      argc > 3 ? std::stol(argv[3]) : config["Nstep"].get<long>();
+  const int runs = argc > 4 ? std::stoi(argv[4]) : 10;
+  const double fraction = argc > 5 ? std::stod(argv[5]) : 0.75;
+  const int window = argc > 6 ? std::stoi(argv[6]) : 1000;
+
+  std::array<double, nstates> values{};
+  if (!ReadPositionValues(config, values)) return 2;
+  // runs must not write gradient dumps
+  if (config.contains("model")) config["model"]["save_grad"] = false;
+
+  const double best = BestAverageReward(values);
+  std::cout << "best average reward " << best << ", threshold "
+            << fraction * best << " over " << window << " steps" << std::endl;
+
+  if (agent == "grid") {
+    Compare<RLlib::TabularSarsaAgent<nstates, nactions, Direction>>(
+        config, values, max_steps, runs, fraction * best, window);
+  } else if (agent == "grid_linear") {
+    Compare<RLlib::LinearSarsaAgent<nstate_dim, nactions, Direction, int>>(
+        config, values, max_steps, runs, fraction * best, window);
+  } else {
+    std::cerr << "Unknown agent: " << agent << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef BENCH_GRID_ENV_H
+#define BENCH_GRID_ENV_H
+#include <agent.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// The 5x6 torus grid the grid benches run on: four moves that wrap around
+// the edges, each paying the value of the cell moved into.
+
+constexpr int nrows = 5;
+constexpr int ncols = 6;
+constexpr int nstates = nrows * ncols;
+constexpr int nstate_dim = 5;
+constexpr int nactions = 4;
+
+using Direction = std::array<int, 2>;
+using Position = std::array<int, 2>;
+
+constexpr std::array<Direction, nactions> kMoves = {
+    Direction{1, 0}, Direction{0, 1}, Direction{-1, 0}, Direction{0, -1}};
+
+inline Position Move(const Position &pos, const Direction &d) {
+  return {(pos[0] + d[0] + nrows) % nrows, (pos[1] + d[1] + ncols) % ncols};
+}
+
+// Karp's maximum mean cycle over the moves graph, edge weight = value of the
+// cell moved into.
+inline double BestAverageReward(const std::array<double, nstates> &values) {
+  constexpr double kUnset = -1e300;
+  std::vector<std::array<double, nstates>> walk(nstates + 1);
+  walk[0].fill(0.0);
+  for (int k = 1; k <= nstates; ++k) {
+    walk[k].fill(kUnset);
+    for (int s = 0; s < nstates; ++s) {
+      for (const auto &d : kMoves) {
+        const auto next = Move({s / ncols, s % ncols}, d);
+        const int t = next[0] * ncols + next[1];
+        walk[k][t] = std::max(walk[k][t], walk[k - 1][s] + values[t]);
+      }
+    }
+  }
+  double best = kUnset;
+  for (int s = 0; s < nstates; ++s) {
+    double worst = 1e300;
+    for (int k = 0; k < nstates; ++k) {
+      worst = std::min(worst, (walk[nstates][s] - walk[k][s]) / (nstates - k));
+    }
+    best = std::max(best, worst);
+  }
+  return best;
+}
+
+// The cell index for tabular agents, quadratic features for linear ones.
+template <typename TAgent>
+typename TAgent::State Observe(const Position &pos) {
+  using State = typename TAgent::State;
+  if constexpr (std::is_same_v<State, int>) {
+    return pos[0] * ncols + pos[1];
+  } else {
+    using Feature = typename State::value_type;
+    return State{static_cast<Feature>(pos[0]), static_cast<Feature>(pos[1]),
+                 static_cast<Feature>(pos[0] * pos[0]),
+                 static_cast<Feature>(pos[1] * pos[1]),
+                 static_cast<Feature>(pos[1] * pos[0])};
+  }
+}
+
+// Reads the cell values from config["position_values_file"]; reports the
+// failure on stderr and returns false if the file cannot be read.
+inline bool ReadPositionValues(const json &config,
+                               std::array<double, nstates> &values) {
+  const auto fname = config["position_values_file"].get<std::string>();
+  std::ifstream ifs(fname);
+  for (int i = 0; i < nstates; ++i) ifs >> values[i];
+  if (ifs.fail()) {
+    std::cerr << "Failed to read state values from " << fname << std::endl;
+    return false;
+  }
+  return true;
+}
+
+#endif
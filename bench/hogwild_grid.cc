@@ -0,0 +1,140 @@
+#include <concurrency.h>
+#include <linear_agents.h>
+#include <tabular_agents.h>
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "grid_env.h"
+
+// Hogwild training on the 5x6 grid: K = 1, 2, 4, ... up to the available
+// cores actor threads, each with its own agent and environment, all updating
+// one shared model, in both the atomic and the striped mode. The total
+// number of steps is fixed, so each thread takes total_steps / K of them.
+// Reports aggregate steps/sec, the speedup over one thread, and how good the
+// learnt greedy policy is: its average reward over eval_steps steps as a
+// fraction of the best achievable average reward (the maximum mean cycle of
+// the torus, by Karp's algorithm).
+//
+// usage: bench_hogwild_grid <grid|grid_linear> <config.json> [total_steps]
+//                           [max_threads] [eval_steps]
+
+using Clock = std::chrono::steady_clock;
+
+// Average reward per step of `agent`, from (0, 0).
+template <typename TAgent>
+double Run(TAgent &agent, const std::array<double, nstates> &values,
+           long steps) {
+  double total = 0.0;
+  Position pos{0, 0};
+  for (long step = 0; step < steps; ++step) {
+    pos = Move(pos, agent.UpdateState(Observe<TAgent>(pos)));
+    const double reward = values[pos[0] * ncols + pos[1]];
+    agent.CollectReward(reward);
+    total += reward;
+  }
+  return total / static_cast<double>(steps);
+}
+
+template <typename TAgent>
+void Sweep(json config, const std::array<double, nstates> &values,
+           long total_steps, int max_threads, long eval_steps) {
+  using Model = typename TAgent::Model;
+  const auto cpus = RLlib::AvailableCpus();
+  std::vector<int> counts;
+  for (int n = 1; n < max_threads; n *= 2) counts.push_back(n);
+  counts.push_back(max_threads);
+
+  const double best = BestAverageReward(values);
+  json greedy = config;
+  greedy["epsilon"] = 0.0;
+  greedy.erase("learning_rates");
+
+  std::cout << "mode\tthreads\tsteps_per_sec\tspeedup\tgreedy_reward"
+            << std::endl;
+  for (const char *mode : RLlib::Models::HogwildModeNames) {
+    config["model"]["hogwild"] = mode;
+    double single = 0.0;
+    for (int n : counts) {
+      Model model(config["model"]);
+      const long steps = total_steps / n;
+      std::barrier<> start(n);
+      // timed by the workers: the main thread may only get to run again
+      // after they are done
+      std::vector<Clock::time_point> begins(n), ends(n);
+      std::vector<std::thread> workers;
+      for (int k = 0; k < n; ++k) {
+        workers.emplace_back([&, k]() {
+          if (!cpus.empty()) RLlib::PinCurrentThread(cpus[k % cpus.size()]);
+          rng_util::set_stream(static_cast<uint64_t>(k) + 1);
+          TAgent agent(kMoves, config, model);
+          start.arrive_and_wait();
+          begins[k] = Clock::now();
+          Run(agent, values, steps);
+          ends[k] = Clock::now();
+        });
+      }
+      for (auto &w : workers) w.join();
+      const auto first = *std::min_element(begins.begin(), begins.end());
+      const auto last = *std::max_element(ends.begin(), ends.end());
+      const double seconds =
+          std::chrono::duration<double>(last - first).count();
+
+      const double rate = static_cast<double>(steps) * n / seconds;
+      if (n == 1) single = rate;
+      TAgent evaluator(kMoves, greedy, model);
+      evaluator.SetLearningRate(0.0);
+      const double reward = Run(evaluator, values, eval_steps);
+      std::cout << mode << "\t" << n << "\t" << std::fixed
+                << std::setprecision(0) << rate << "\t" << std::setprecision(2)
+                << rate / single << "\t" << std::setprecision(3)
+                << reward / best << std::defaultfloat << std::endl;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0]
+              << " <grid|grid_linear> <config.json> [total_steps]"
+                 " [max_threads] [eval_steps]"
+              << std::endl;
+    return 1;
+  }
+  const std::string agent = argv[1];
+  json config = RLlib::load_json(argv[2]);
+  const long total_steps =
+      argc > 3 ? std::stol(argv[3]) : config["Nstep"].get<long>();
+  const int max_threads =
+      argc > 4 ? std::stoi(argv[4])
+               : std::max(1, static_cast<int>(RLlib::AvailableCpus().size()));
+  if (max_threads < 1) {
+    std::cerr << "max_threads must be >= 1" << std::endl;
+    return 1;
+  }
+  const long eval_steps = argc > 5 ? std::stol(argv[5]) : 10000;
+
+  std::array<double, nstates> values{};
+  if (!ReadPositionValues(config, values)) return 2;
+
+  rng_util::seed(config.value("seed", uint64_t{0}));
+  config.erase("seed");
+
+  if (agent == "grid") {
+    Sweep<RLlib::HogwildTabularSarsaAgent<nstates, nactions, Direction>>(
+        config, values, total_steps, max_threads, eval_steps);
+  } else if (agent == "grid_linear") {
+    Sweep<RLlib::HogwildLinearSarsaAgent<nstate_dim, nactions, Direction, int>>(
+        config, values, total_steps, max_threads, eval_steps);
+  } else {
+    std::cerr << "Unknown agent: " << agent << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include <models/torch/jit.h>
+#include <random_generator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Acting latency of JITNetwork on the trainable TorchScript module against
+// the frozen / optimize_for_inference copy, with and without warmup at load:
+// the time to construct the network, the first GetActionValues call, and the
+// median and 99th percentile of the steady state. Then the learner's side:
+// the median cost of RefreshInference(), as OffPolicyReplayLearner pays it on
+// every snapshot publish and hard target sync, and of the first acting call
+// after it, with and without refresh warmup.
+//
+// usage: bench_jit_inference [model.pt] [iterations]
+// The model must map [N, 5] to [N, 4], as inputs/qlinear.pt does
+// (scripts/linear.py 5 4).
+
+constexpr int kFeatures = 5;
+constexpr int kActions = 4;
+
+using Network = RLlib::Models::JITNetwork<kFeatures, kActions, float, float>;
+
+using Clock = std::chrono::steady_clock;
+
+double Ns(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+void Run(const std::string &name, const json &config, int iterations) {
+  auto start = Clock::now();
+  Network net(config);
+  const double load_ns = Ns(start, Clock::now());
+
+  std::vector<Network::State> states(64);
+  for (auto &state : states) {
+    for (auto &x : state) x = static_cast<float>(rng_util::uniform01());
+  }
+
+  volatile float sink = 0.0f;
+  start = Clock::now();
+  sink = sink + net.GetActionValues(states[0])[0];
+  const double first_ns = Ns(start, Clock::now());
+
+  std::vector<double> latencies(iterations);
+  for (int i = 0; i < iterations; ++i) {
+    start = Clock::now();
+    sink = sink + net.GetActionValues(states[i % states.size()])[i % kActions];
+    latencies[i] = Ns(start, Clock::now());
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  std::cout << name << "\t" << load_ns / 1e6 << "\t" << first_ns / 1e3 << "\t"
+            << latencies[iterations / 2] << "\t"
+            << latencies[iterations * 99 / 100] << std::endl;
+}
+
+void RunRefresh(const std::string &name, const json &config, int refreshes) {
+  Network net(config);
+  Network::State state;
+  for (auto &x : state) x = static_cast<float>(rng_util::uniform01());
+
+  volatile float sink = 0.0f;
+  std::vector<double> refresh_ns(refreshes);
+  std::vector<double> first_ns(refreshes);
+  for (int r = 0; r < refreshes; ++r) {
+    auto start = Clock::now();
+    net.RefreshInference();
+    refresh_ns[r] = Ns(start, Clock::now());
+    start = Clock::now();
+    sink = sink + net.GetActionValues(state)[0];
+    first_ns[r] = Ns(start, Clock::now());
+    // settle into the steady state before the next refresh
+    for (int i = 0; i < 100; ++i) sink = sink + net.GetActionValues(state)[0];
+  }
+  std::sort(refresh_ns.begin(), refresh_ns.end());
+  std::sort(first_ns.begin(), first_ns.end());
+
+  std::cout << name << "\t" << refresh_ns[refreshes / 2] / 1e6 << "\t"
+            << first_ns[refreshes / 2] / 1e3 << std::endl;
+}
+
+int main(int argc, char **argv) {
+  const std::string path = argc > 1 ? argv[1] : "inputs/qlinear.pt";
+  const int iterations = argc > 2 ? std::stoi(argv[2]) : 100000;
+
+  const json base = {{"model_path", path}};
+  auto with_inference = [&](bool optimize, int warmup,
+                            int refresh_warmup = 0) {
+    json config = base;
+    config["inference"] = {{"freeze", true},
+                           {"optimize", optimize},
+                           {"warmup", warmup},
+                           {"refresh_warmup", refresh_warmup}};
+    return config;
+  };
+
+  std::cout << "mode\tload_ms\tfirst_us\tp50_ns\tp99_ns" << std::endl;
+  Run("trainable", base, iterations);
+  Run("frozen", with_inference(false, 0), iterations);
+  Run("frozen+warmup", with_inference(false, 10), iterations);
+  Run("optimized", with_inference(true, 0), iterations);
+  Run("optimized+warmup", with_inference(true, 10), iterations);
+
+  constexpr int kRefreshes = 50;
+  std::cout << "\nrefresh\trefresh_ms\tfirst_us" << std::endl;
+  RunRefresh("frozen", with_inference(false, 10), kRefreshes);
+  RunRefresh("frozen+warmup", with_inference(false, 10, 10), kRefreshes);
+  RunRefresh("optimized", with_inference(true, 10), kRefreshes);
+  RunRefresh("optimized+warmup", with_inference(true, 10, 10), kRefreshes);
+  return 0;
+}
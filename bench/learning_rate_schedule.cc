@@ -0,0 +1,54 @@
+#include <extern/tinyexpr.h>
+#include <schedule.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Per-step cost of evaluating the learning rate: the old per-step
+// te_compile/te_eval/te_free path against the precompiled and native
+// schedules.
+
+constexpr int kRounds = 200000;
+constexpr const char *kFormula = "0.1 / (round + 1) + 0.01";
+
+template <typename TFunc>
+void Report(const std::string &name, TFunc &&eval) {
+  volatile double sink = 0.0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 1; round <= kRounds; ++round) {
+    sink = sink + eval(round);
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns =
+      std::chrono::duration<double, std::nano>(end - start).count() / kRounds;
+  std::cout << name << "\t" << ns << " ns/step" << std::endl;
+}
+
+int main() {
+  Report("tinyexpr_per_step", [](int round) {
+    double round_double = static_cast<double>(round);
+    te_variable vars[] = {{"round", &round_double}};
+    int err;
+    te_expr *expr = te_compile(kFormula, vars, 1, &err);
+    double lr = te_eval(expr);
+    te_free(expr);
+    return lr;
+  });
+
+  RLlib::Schedule formula{json(kFormula)};
+  Report("formula_precompiled", [&](int round) { return formula.Value(round); });
+
+  RLlib::Schedule inverse_time{json{{"type", "inverse_time"},
+                                    {"initial", 0.1},
+                                    {"decay", 1.0},
+                                    {"minimum", 0.01}}};
+  Report("native_inverse_time",
+         [&](int round) { return inverse_time.Value(round); });
+
+  RLlib::Schedule cosine{json{
+      {"type", "cosine"}, {"initial", 0.1}, {"minimum", 0.01},
+      {"period", kRounds}}};
+  Report("native_cosine", [&](int round) { return cosine.Value(round); });
+  return 0;
+}
@@ -0,0 +1,61 @@
+#include <models/linear.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Forward and update cost of SimpleLinearModel for tFeaturesDim from 4 to
+// 4096, per SIMD level and with/without the fused all-actions forward.
+
+constexpr int kActions = 4;
+constexpr int kIterations = 200000;
+
+template <int tFeatures>
+void Run(const std::string &simd, bool fused) {
+  using Model = RLlib::Models::SimpleLinearModel<tFeatures, kActions>;
+  Model model(json{{"weights", {{"mean", 0.0}, {"stddev", 0.1}}},
+                   {"learning_rate", 1e-6},
+                   {"simd", simd},
+                   {"fused_forward", fused}});
+  typename Model::State state;
+  for (int j = 0; j < tFeatures; ++j) state[j] = rng_util::uniform01();
+
+  const int iterations = std::max(1000, kIterations * 16 / tFeatures);
+  volatile double sink = 0.0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    sink = sink + model.GetActionValues(state)[i % kActions];
+  }
+  auto mid = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    model.Update(state, i % kActions, 1.0);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << tFeatures << "\t" << simd << "\t" << fused << "\t"
+            << std::chrono::duration<double, std::nano>(mid - start).count() /
+                   iterations
+            << "\t"
+            << std::chrono::duration<double, std::nano>(end - mid).count() /
+                   iterations
+            << std::endl;
+}
+
+template <int tFeatures>
+void Sweep() {
+  for (const char *simd : {"scalar", "avx2", "avx512"}) {
+    Run<tFeatures>(simd, false);
+    Run<tFeatures>(simd, true);
+  }
+}
+
+int main() {
+  std::cout << "features\tsimd\tfused\tforward_ns\tupdate_ns" << std::endl;
+  Sweep<4>();
+  Sweep<16>();
+  Sweep<64>();
+  Sweep<256>();
+  Sweep<1024>();
+  Sweep<4096>();
+  return 0;
+}
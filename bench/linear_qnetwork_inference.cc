@@ -0,0 +1,62 @@
+#include <models/torch/linear.h>
+#include <random_generator.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Single-state GetActionValues latency of LinearQNetwork on the native
+// MultiDot path against the libtorch from_blob + linear path, for a few layer
+// sizes, plus a [32, features] batch for reference.
+
+constexpr int kIterations = 200000;
+constexpr int kBatch = 32;
+
+template <int tFeatures, int tActions>
+void Run(bool native) {
+  using Network = RLlib::Models::LinearQNetwork<tFeatures, tActions>;
+  Network net(json{{"weights", {{"mean", 0.0}, {"stddev", 0.1}}},
+                   {"native_inference", native}});
+  std::vector<typename Network::State> states(kBatch);
+  for (auto &state : states) {
+    for (auto &x : state) x = rng_util::uniform01();
+  }
+
+  const int iterations = native ? kIterations : kIterations / 10;
+  volatile double sink = 0.0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    sink = sink + net.GetActionValues(states[i % kBatch])[i % tActions];
+  }
+  auto mid = std::chrono::steady_clock::now();
+  const int batches = iterations / kBatch + 1;
+  for (int i = 0; i < batches; ++i) {
+    sink = sink + net.GetBatchActionValues(states)[i % kBatch][0];
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << tFeatures << "x" << tActions << "\t"
+            << (native ? "native" : "torch") << "\t"
+            << std::chrono::duration<double, std::nano>(mid - start).count() /
+                   iterations
+            << "\t"
+            << std::chrono::duration<double, std::nano>(end - mid).count() /
+                   batches / kBatch
+            << std::endl;
+}
+
+template <int tFeatures, int tActions>
+void Compare() {
+  Run<tFeatures, tActions>(false);
+  Run<tFeatures, tActions>(true);
+}
+
+int main() {
+  std::cout << "layer\tpath\tsingle_ns\tbatch_ns_per_state" << std::endl;
+  Compare<5, 4>();
+  Compare<16, 4>();
+  Compare<64, 16>();
+  Compare<256, 16>();
+  Compare<1024, 32>();
+  return 0;
+}
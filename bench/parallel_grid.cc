@@ -0,0 +1,167 @@
+#include <concurrency.h>
+#include <linear_agents.h>
+#include <tabular_agents.h>
+#include <torch_agents.h>
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "grid_env.h"
+
+// Runs K independent agent + 5x6 grid instances, one per pinned worker
+// thread, for K = 1, 2, 4, ... up to the available cores, and reports
+// aggregate steps/sec, pooled p50/p99 per-step latency and scaling
+// efficiency relative to one core.
+//
+// usage: bench_parallel_grid <grid|grid_linear|grid_linear_torch|
+//                             grid_linear_jit> <config.json>
+//                            [steps_per_instance] [max_threads]
+
+using Clock = std::chrono::steady_clock;
+
+struct WorkerResult {
+  double seconds{};
+  std::vector<float> latencies_ns;
+};
+
+template <typename TAgent>
+void Worker(const json &config, const std::array<double, nstates> &values,
+            int steps, int instance, int cpu, std::atomic<int> &turn,
+            std::barrier<> &start, WorkerResult &result) {
+  // cpu < 0: the CPUs are unknown, leave the thread unpinned
+  if (cpu >= 0) RLlib::PinCurrentThread(cpu);
+  // Instances are built one at a time in instance order, each on its own
+  // stream, so random initialization and any new_stream() the agent takes
+  // (e.g. a replay sampler's) do not depend on how the threads race.
+  while (turn.load(std::memory_order_acquire) != instance) {
+    std::this_thread::yield();
+  }
+  rng_util::set_stream(static_cast<uint64_t>(instance) + 1);
+  // build on the pinned core so the agent's memory is local to it
+  TAgent agent(kMoves, config);
+  turn.fetch_add(1, std::memory_order_release);
+  result.latencies_ns.resize(steps);
+  Position pos{0, 0};
+
+  start.arrive_and_wait();
+  const auto begin = Clock::now();
+  auto last = begin;
+  for (int step = 0; step < steps; ++step) {
+    pos = Move(pos, agent.UpdateState(Observe<TAgent>(pos)));
+    agent.CollectReward(values[pos[0] * ncols + pos[1]]);
+    const auto now = Clock::now();
+    result.latencies_ns[step] =
+        std::chrono::duration<float, std::nano>(now - last).count();
+    last = now;
+  }
+  result.seconds = std::chrono::duration<double>(last - begin).count();
+}
+
+double Percentile(std::vector<float> &samples, double q) {
+  auto nth = samples.begin() + static_cast<std::ptrdiff_t>(
+                                   q * static_cast<double>(samples.size() - 1));
+  std::nth_element(samples.begin(), nth, samples.end());
+  return *nth;
+}
+
+template <typename TAgent>
+void Sweep(const json &config, const std::array<double, nstates> &values,
+           int steps, int max_threads) {
+  const auto cpus = RLlib::AvailableCpus();
+  std::vector<int> counts;
+  for (int n = 1; n < max_threads; n *= 2) counts.push_back(n);
+  counts.push_back(max_threads);
+
+  std::cout << "threads\tsteps_per_sec\tp50_ns\tp99_ns\tefficiency"
+            << std::endl;
+  double single = 0.0;
+  for (int n : counts) {
+    std::vector<WorkerResult> results(n);
+    std::atomic<int> turn{0};
+    std::barrier<> start(n);
+    std::vector<std::thread> workers;
+    for (int k = 0; k < n; ++k) {
+      workers.emplace_back(Worker<TAgent>, std::cref(config), std::cref(values),
+                           steps, k,
+                           cpus.empty() ? -1 : cpus[k % cpus.size()],
+                           std::ref(turn),
+                           std::ref(start), std::ref(results[k]));
+    }
+    for (auto &w : workers) w.join();
+
+    double slowest = 0.0;
+    std::vector<float> pooled;
+    pooled.reserve(static_cast<std::size_t>(n) * steps);
+    for (const auto &r : results) {
+      slowest = std::max(slowest, r.seconds);
+      pooled.insert(pooled.end(), r.latencies_ns.begin(),
+                    r.latencies_ns.end());
+    }
+    const double rate = static_cast<double>(n) * steps / slowest;
+    if (n == 1) single = rate;
+    std::cout << n << "\t" << std::fixed << std::setprecision(0) << rate
+              << "\t" << Percentile(pooled, 0.50) << "\t"
+              << Percentile(pooled, 0.99) << "\t" << std::setprecision(3)
+              << rate / (n * single) << std::defaultfloat << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0]
+              << " <grid|grid_linear|grid_linear_torch|grid_linear_jit>"
+                 " <config.json> [steps_per_instance] [max_threads]"
+              << std::endl;
+    return 1;
+  }
+  const std::string agent = argv[1];
+  json config = RLlib::load_json(argv[2]);
+  const int steps = argc > 3 ? std::stoi(argv[3]) : config["Nstep"].get<int>();
+  const int max_threads =
+      argc > 4 ? std::stoi(argv[4])
+               : std::max(1, static_cast<int>(RLlib::AvailableCpus().size()));
+  if (max_threads < 1) {
+    std::cerr << "max_threads must be >= 1" << std::endl;
+    return 1;
+  }
+
+  std::array<double, nstates> values{};
+  if (!ReadPositionValues(config, values)) return 2;
+
+  // one seed for the whole sweep; instance k draws from stream k + 1, and
+  // streams handed out by new_stream() come after all of them
+  rng_util::seed(config.value("seed", uint64_t{0}));
+  rng_util::reserve_streams(static_cast<uint64_t>(max_threads));
+  config.erase("seed");
+  // instances must not share the gradient dump
+  if (config.contains("model")) config["model"]["save_grad"] = false;
+  // one intra-op thread per instance, scaling comes from the instances
+  torch::set_num_threads(1);
+
+  if (agent == "grid") {
+    Sweep<RLlib::TabularSarsaAgent<nstates, nactions, Direction>>(
+        config, values, steps, max_threads);
+  } else if (agent == "grid_linear") {
+    Sweep<RLlib::LinearSarsaAgent<nstate_dim, nactions, Direction, int>>(
+        config, values, steps, max_threads);
+  } else if (agent == "grid_linear_torch") {
+    Sweep<RLlib::OffPolicyLinearSarsaAgent<nstate_dim, nactions, Direction,
+                                           double>>(config, values, steps,
+                                                    max_threads);
+  } else if (agent == "grid_linear_jit") {
+    Sweep<RLlib::OffPolicyQNetSarsaAgent<nstate_dim, nactions, Direction,
+                                         double>>(config, values, steps,
+                                                  max_threads);
+  } else {
+    std::cerr << "Unknown agent: " << agent << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include <models/replay_sampler.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Per-update cost of prioritized replay (sample a minibatch, then write back
+// its TD errors) for replay capacities up to several million, in
+// proportional mode and in rank mode at two re-sort intervals (whose full
+// sort is amortized over the interval).
+
+constexpr std::size_t kBatchSize = 32;
+constexpr int kUpdates = 100000;
+
+int main() {
+  std::minstd_rand rng(42);
+  std::uniform_real_distribution<double> error_dist(0.0, 2.0);
+  std::vector<double> td_errors(kBatchSize);
+
+  struct Setting {
+    const char *mode;
+    int rank_sort_interval;
+  };
+  std::cout << "mode\tsort_interval\tcapacity\tfill_ns_per_push"
+               "\tns_per_update"
+            << std::endl;
+  for (const Setting &setting :
+       {Setting{"proportional", 0}, Setting{"rank", 10000},
+        Setting{"rank", 1000}}) {
+    const char *mode = setting.mode;
+    for (std::size_t capacity : {10000ul, 100000ul, 1000000ul, 4000000ul}) {
+      json config = {{"mode", mode}};
+      if (setting.rank_sort_interval > 0) {
+        config["rank_sort_interval"] = setting.rank_sort_interval;
+      }
+      RLlib::Models::PrioritizedSampler sampler(capacity, config, kBatchSize);
+
+      auto start = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < capacity; ++i) {
+        sampler.Add(i);
+      }
+      auto filled = std::chrono::steady_clock::now();
+
+      for (int u = 0; u < kUpdates; ++u) {
+        const auto &indices = sampler.Sample(kBatchSize, rng);
+        for (auto &e : td_errors) e = error_dist(rng);
+        sampler.UpdatePriorities(indices, td_errors.data());
+      }
+      auto end = std::chrono::steady_clock::now();
+
+      std::cout << mode << "\t" << setting.rank_sort_interval << "\t"
+                << capacity << "\t"
+                << std::chrono::duration<double, std::nano>(filled - start)
+                           .count() /
+                       capacity
+                << "\t"
+                << std::chrono::duration<double, std::nano>(end - filled)
+                           .count() /
+                       kUpdates
+                << std::endl;
+    }
+  }
+  return 0;
+}
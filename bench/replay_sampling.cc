@@ -0,0 +1,56 @@
+#include <models/replay_sampler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// Per-update cost of drawing a minibatch of indices as the replay buffer
+// grows: the old iota + full shuffle against MinibatchSampler.
+
+constexpr std::size_t kBatchSize = 32;
+
+template <typename TFunc>
+double NsPerUpdate(int updates, TFunc &&sample) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < updates; ++i) {
+    sample();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         updates;
+}
+
+int main() {
+  std::minstd_rand rng(42);
+  std::cout << "capacity\tfull_shuffle\twithout_replacement\twith_replacement"
+            << " (ns/update)" << std::endl;
+  for (std::size_t capacity : {1000ul, 10000ul, 100000ul, 1000000ul,
+                               4000000ul}) {
+    int shuffle_updates = static_cast<int>(
+        std::max<std::size_t>(10, 20000000 / capacity));
+    std::vector<std::size_t> reshuffle_indices(capacity);
+    volatile std::size_t sink = 0;
+    double shuffle_ns = NsPerUpdate(shuffle_updates, [&]() {
+      std::iota(reshuffle_indices.begin(), reshuffle_indices.end(), 0);
+      std::shuffle(reshuffle_indices.begin(), reshuffle_indices.end(), rng);
+      sink = sink + reshuffle_indices[0];
+    });
+
+    RLlib::Models::MinibatchSampler without(false, kBatchSize);
+    double without_ns = NsPerUpdate(100000, [&]() {
+      sink = sink + without.Sample(capacity, kBatchSize, rng)[0];
+    });
+
+    RLlib::Models::MinibatchSampler with(true, kBatchSize);
+    double with_ns = NsPerUpdate(100000, [&]() {
+      sink = sink + with.Sample(capacity, kBatchSize, rng)[0];
+    });
+
+    std::cout << capacity << "\t" << shuffle_ns << "\t" << without_ns << "\t"
+              << with_ns << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include <random_generator.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Cost per draw of the old mt19937_64 + std distributions versus the
+// xoshiro256++ / Philox generators, one at a time and batched.
+
+constexpr std::size_t kDraws = 1 << 24;
+constexpr std::size_t kBatch = 1024;
+
+template <typename TFn>
+void Time(const std::string &name, TFn &&fn) {
+  volatile double sink = 0.0;
+  auto start = std::chrono::steady_clock::now();
+  sink = sink + fn();
+  auto end = std::chrono::steady_clock::now();
+  std::cout << name << "\t"
+            << std::chrono::duration<double, std::nano>(end - start).count() /
+                   kDraws
+            << std::endl;
+}
+
+int main() {
+  std::cout << "generator\tns_per_draw" << std::endl;
+
+  std::mt19937_64 mt(1);
+  Time("mt19937_64 uniform", [&] {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    double s = 0.0;
+    for (std::size_t i = 0; i < kDraws; ++i) s += dist(mt);
+    return s;
+  });
+  Time("mt19937_64 normal (new dist per call)", [&] {
+    double s = 0.0;
+    for (std::size_t i = 0; i < kDraws; ++i) {
+      s += std::normal_distribution<double>(0.0, 1.0)(mt);
+    }
+    return s;
+  });
+
+  rng_util::Xoshiro256PlusPlus xo(1);
+  Time("xoshiro256++ uniform", [&] {
+    double s = 0.0;
+    for (std::size_t i = 0; i < kDraws; ++i) s += rng_util::to_unit(xo());
+    return s;
+  });
+  rng_util::Philox4x32 philox(1);
+  Time("philox4x32 uniform", [&] {
+    double s = 0.0;
+    for (std::size_t i = 0; i < kDraws; ++i) s += rng_util::to_unit(philox());
+    return s;
+  });
+  Time("rng_util::uniform01", [&] {
+    double s = 0.0;
+    for (std::size_t i = 0; i < kDraws; ++i) s += rng_util::uniform01();
+    return s;
+  });
+  Time("rng_util::normal", [&] {
+    double s = 0.0;
+    for (std::size_t i = 0; i < kDraws; ++i) s += rng_util::normal();
+    return s;
+  });
+
+  std::vector<double> buffer(kBatch);
+  Time("xoshiro256++ fill_uniform", [&] {
+    double s = 0.0;
+    for (std::size_t i = 0; i < kDraws; i += kBatch) {
+      rng_util::fill_uniform(xo, buffer.data(), kBatch);
+      s += buffer[0];
+    }
+    return s;
+  });
+  Time("xoshiro256++ fill_normal", [&] {
+    double s = 0.0;
+    for (std::size_t i = 0; i < kDraws; i += kBatch) {
+      rng_util::fill_normal(xo, buffer.data(), kBatch);
+      s += buffer[0];
+    }
+    return s;
+  });
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <models/linear.h>
+#include <models/sparse_features.h>
+#include <models/sparse_linear.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Forward and update cost of SimpleLinearModel on dense tile-coded states
+// against SparseLinearModel on the same codes as (index, value) lists, for
+// 8 and 32 tilings over a 4-d observation hashed into tFeatures features.
+// The dense model pays for every feature; the sparse one only for the
+// active ones, plus cache misses once the weights outgrow the cache.
+
+constexpr int kActions = 4;
+constexpr int kDims = 4;
+constexpr int kStates = 1024;
+constexpr int kOps = 400000;
+
+template <typename TFunc>
+double NsPerOp(int ops, TFunc &&op) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ops; ++i) op(i);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+template <int tTilings>
+std::vector<RLlib::Models::SparseState<tTilings>> Encode(std::uint64_t size) {
+  RLlib::Models::TileCoder<kDims, tTilings> coder(
+      json{{"low", 0.0}, {"high", 1.0}, {"tiles", 16}, {"size", size}});
+  std::vector<RLlib::Models::SparseState<tTilings>> states(kStates);
+  for (auto &state : states) {
+    typename decltype(coder)::Observation x;
+    for (auto &v : x) v = rng_util::uniform01();
+    coder.Encode(x, state);
+  }
+  return states;
+}
+
+template <typename TModel, typename TState>
+void Run(const char *name, int features, int active, TModel &model,
+         const std::vector<TState> &states, int ops) {
+  volatile double sink = 0.0;
+  const double forward_ns = NsPerOp(ops, [&](int i) {
+    sink = sink + model.GetActionValues(states[i % kStates])[i % kActions];
+  });
+  const double update_ns = NsPerOp(ops, [&](int i) {
+    model.Update(states[i % kStates], i % kActions, 1.0);
+  });
+  std::cout << name << "\t" << features << "\t" << active << "\t"
+            << forward_ns << "\t" << update_ns << std::endl;
+}
+
+template <int tFeatures, int tTilings>
+void Dense() {
+  using Model = RLlib::Models::SimpleLinearModel<tFeatures, kActions>;
+  // far too large for the stack
+  auto model = std::make_unique<Model>(
+      json{{"weights", 0.0}, {"learning_rate", 1e-3}});
+  std::vector<typename Model::State> states(kStates);
+  const auto codes = Encode<tTilings>(tFeatures);
+  for (int s = 0; s < kStates; ++s) {
+    states[s].fill(0.0);
+    for (const auto &f : codes[s]) states[s][f.index] += f.value;
+  }
+  Run("dense", tFeatures, tTilings, *model, states,
+      std::max(1000, kOps * 64 / tFeatures));
+}
+
+template <int tFeatures, int tTilings>
+void Sparse() {
+  RLlib::Models::SparseLinearModel<tFeatures, kActions, tTilings> model(
+      json{{"weights", 0.0}, {"learning_rate", 1e-3}});
+  Run("sparse", tFeatures, tTilings, model, Encode<tTilings>(tFeatures),
+      kOps);
+}
+
+int main() {
+  std::cout << "model\tfeatures\tactive\tforward_ns\tupdate_ns" << std::endl;
+  Dense<1 << 12, 8>();
+  Sparse<1 << 12, 8>();
+  Dense<1 << 12, 32>();
+  Sparse<1 << 12, 32>();
+  Dense<1 << 16, 32>();
+  Sparse<1 << 16, 32>();
+  Sparse<1 << 20, 8>();
+  Sparse<1 << 20, 32>();
+  return 0;
+}
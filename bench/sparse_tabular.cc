@@ -0,0 +1,101 @@
+#include <models/sparse_tabular.h>
+#include <models/tabular.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Update and lookup cost of the dense Tabular against SparseTabular, with
+// the memory each needs, when a run visits `visited` distinct states out of
+// a state space of `states`. Dense tables stop at 10^6 states (24 MB with 3
+// actions); the sparse one goes on to 10^9 and 10^12.
+
+constexpr int kActions = 3;
+constexpr int kOps = 4000000;
+
+template <typename TFunc>
+double NsPerOp(TFunc &&op) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kOps; ++i) op(i);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / kOps;
+}
+
+// The visited states and a random access sequence over them.
+struct Workload {
+  std::vector<std::uint64_t> visited;
+  std::vector<std::uint32_t> order;
+};
+
+Workload MakeWorkload(std::uint64_t states, std::size_t visited) {
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<std::uint64_t> state(0, states - 1);
+  Workload w;
+  w.visited.resize(visited);
+  for (auto &s : w.visited) s = state(rng);
+  std::uniform_int_distribution<std::uint32_t> pick(
+      0, static_cast<std::uint32_t>(visited - 1));
+  w.order.resize(kOps);
+  for (auto &i : w.order) i = pick(rng);
+  return w;
+}
+
+template <typename TModel>
+void Run(const char *name, std::uint64_t states, TModel &model,
+         const Workload &w) {
+  volatile double sink = 0.0;
+  const double update_ns = NsPerOp([&](int i) {
+    const auto s = static_cast<typename TModel::State>(w.visited[w.order[i]]);
+    model.Update(s, i % kActions, 1.0);
+  });
+  const double lookup_ns = NsPerOp([&](int i) {
+    const auto s = static_cast<typename TModel::State>(w.visited[w.order[i]]);
+    sink = sink + model.GetActionValues(s)[0];
+  });
+  std::size_t bytes = sizeof(TModel);
+  if constexpr (requires { model.MemoryBytes(); }) {
+    bytes = model.MemoryBytes();
+  }
+  std::cout << name << "\t" << states << "\t" << w.visited.size() << "\t"
+            << update_ns << "\t" << lookup_ns << "\t" << bytes << std::endl;
+}
+
+template <int tStates>
+void Dense(std::size_t visited) {
+  using Model = RLlib::Models::Tabular<tStates, kActions>;
+  // far too large for the stack
+  auto model = std::make_unique<Model>(json{{"action_values", 0.0}});
+  model->SetLearningRate(0.1);
+  Run("dense", tStates, *model, MakeWorkload(tStates, visited));
+}
+
+void Sparse(std::uint64_t states, std::size_t visited) {
+  RLlib::Models::SparseTabular<kActions> model(
+      json{{"action_values", 0.0}, {"learning_rate", 0.1}});
+  Run("sparse", states, model, MakeWorkload(states, visited));
+}
+
+int main() {
+  std::cout << "model\tstates\tvisited\tupdate_ns\tlookup_ns\tbytes"
+            << std::endl;
+  Dense<10000>(10000);
+  Sparse(10000, 10000);
+  Dense<1000000>(100000);
+  Sparse(1000000, 100000);
+  Sparse(1000000000, 100000);
+  Sparse(1000000000000, 1000000);
+
+  RLlib::Models::SparseTabular<kActions> model(json{{"action_values", 0.0}});
+  const auto w = MakeWorkload(1000000000000, 1000000);
+  for (auto s : w.visited) model.Update(s, 0, 1.0);
+  std::cout << "10^12 states, 10^6 visited: ";
+  model.MemoryReport(std::cout);
+  std::cout << "dense equivalent bytes: "
+            << RLlib::Models::SparseTabular<kActions>::DenseBytes(
+                   1000000000000)
+            << std::endl;
+  return 0;
+}
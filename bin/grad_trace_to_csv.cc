@@ -0,0 +1,46 @@
+#include <grad_trace.h>
+
+#include <iostream>
+#include <string>
+
+// Converts a binary gradient trace (save_grad) to CSV on stdout: one line
+// per traced update, with a column header whenever the record shape changes.
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <trace file>" << std::endl;
+    return 1;
+  }
+  using Header = RLlib::GradTrace::RecordHeader;
+  Header shape{};
+  bool first = true;
+  auto columns = [](const char *name, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) std::cout << "," << name << i;
+  };
+  auto values = [](std::span<const double> v) {
+    for (double x : v) std::cout << "," << x;
+  };
+  RLlib::ReadGradTrace(
+      argv[1], [&](const Header &header, const RLlib::GradTrace::Record &r) {
+        if (first || header.batch != shape.batch ||
+            header.features != shape.features ||
+            header.grad_elems != shape.grad_elems) {
+          std::cout << "update";
+          columns("state_", r.states.size());
+          columns("action_", r.actions.size());
+          columns("last_q_", r.last_q.size());
+          columns("new_q_", r.new_q.size());
+          columns("grad_", r.grad.size());
+          std::cout << "\n";
+          shape = header;
+          first = false;
+        }
+        std::cout << header.update;
+        values(r.states);
+        values(r.actions);
+        values(r.last_q);
+        values(r.new_q);
+        values(r.grad);
+        std::cout << "\n";
+      });
+  return 0;
+}
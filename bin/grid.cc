@@ -1,9 +1,12 @@
 // #include <agents/sarsa.h>
 #include <tabular_agents.h>
+#include <snapshot_writer.h>
+#include <trajectory_recorder.h>
 
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <memory>
 
 constexpr int nrows = 5;
 constexpr int ncols = 6;
@@ -61,9 +64,16 @@ int main(int, char **argv) {
 
   int state = 0;
 
-  std::vector<double> rewards(Nstep, 0.0);
-  std::vector<int> states(Nstep, 0);
+  // streamed in fixed-size chunks: memory does not grow with Nstep
+  RLlib::TrajectoryRecorder trajectory(
+      config.value("trajectory", json::object()), 2);
   // agent.SetLearningRate(0.1);
+  // periodic model snapshots, written by a background thread
+  std::unique_ptr<RLlib::SnapshotWriter<double>> snapshots;
+  if (config.contains("snapshot")) {
+    snapshots = std::make_unique<RLlib::SnapshotWriter<double>>(
+        config["snapshot"], nstates, nactions);
+  }
   for (int step = 0; step < Nstep; ++step) {
     auto action = agent.UpdateState(state);
 
@@ -71,39 +81,17 @@ int main(int, char **argv) {
                 (coords(state).second + action.second + ncols) % ncols);
     // agent.SetLearningRate(0.1 / (step + 1));
     auto reward = state_values[state];
-    rewards[step] = reward;
-    states[step] = state;
+    trajectory.Record(reward, {coords(state).first, coords(state).second});
     agent.CollectReward(reward);
-    agent.GetModel().OutputModel("./intermediate_model.txt", ',',
-                                 step == 0 ? false : true);
+    if (snapshots && snapshots->Due(step)) {
+      snapshots->Push(step, agent.GetModel().ParameterData());
+    }
   }
 
   std::cout << "Finished " << Nstep << " steps." << std::endl;
 
-  {
-    std::cout << "Writing rewards to files..." << std::endl;
-    std::ofstream ofs("./rewards.txt");
-    if (!ofs.is_open()) {
-      std::cerr << "Failed to open ./rewards.txt for writing" << std::endl;
-      return 4;
-    }
-    for (const auto &r : rewards) {
-      ofs << r << std::endl;
-    }
-    ofs.close();
-  }
-  {
-    std::cout << "Writing states to files..." << std::endl;
-    std::ofstream ofs("./states.txt");
-    if (!ofs.is_open()) {
-      std::cerr << "Failed to open ./states.txt for writing" << std::endl;
-      return 5;
-    }
-    for (const auto &r : states) {
-      ofs << coords(r).first << "," << coords(r).second << std::endl;
-    }
-    ofs.close();
-  }
+  trajectory.Flush();
+  std::cout << "Recorded " << trajectory.Steps() << " steps." << std::endl;
   agent.GetModel().OutputModel("./trained_model.txt");
   return 0;
 }
\ No newline at end of file
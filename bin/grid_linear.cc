@@ -1,9 +1,12 @@
 // #include <agents/sarsa.h>
 #include <linear_agents.h>
+#include <snapshot_writer.h>
+#include <trajectory_recorder.h>
 
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <memory>
 
 constexpr int nrows = 5;
 constexpr int ncols = 6;
@@ -64,11 +67,18 @@ int main(int, char **argv) {
 
   auto pos = Position{0, 0};
 
-  std::vector<double> rewards(Nstep, 0.0);
-  std::vector<Position> positions(Nstep, {{}});
+  // streamed in fixed-size chunks: memory does not grow with Nstep
+  RLlib::TrajectoryRecorder trajectory(
+      config.value("trajectory", json::object()), 2);
   auto features = [](const Position &s) {
     return State{s[0], s[1], s[0] * s[0], s[1] * s[1], s[1] * s[0]};
   };
+  // periodic model snapshots, written by a background thread
+  std::unique_ptr<RLlib::SnapshotWriter<double>> snapshots;
+  if (config.contains("snapshot")) {
+    snapshots = std::make_unique<RLlib::SnapshotWriter<double>>(
+        config["snapshot"], nactions, nstate_dim);
+  }
   for (int step = 0; step < Nstep; ++step) {
     auto action = agent.UpdateState(features(pos));
 
@@ -80,39 +90,17 @@ int main(int, char **argv) {
     // agent.SetLearningRate(0.1 / (step + 1) + 0.001);
     auto reward = pos_values[loc(pos)];
 
-    rewards[step] = reward;
-    positions[step] = pos;
+    trajectory.Record(reward, {pos[0], pos[1]});
     agent.CollectReward(reward);
-    agent.GetModel().OutputModel("./intermediate_model.txt", ',',
-                                 step == 0 ? false : true);
+    if (snapshots && snapshots->Due(step)) {
+      snapshots->Push(step, agent.GetModel().ParameterData());
+    }
   }
 
   std::cout << "Finished " << Nstep << " steps." << std::endl;
 
-  {
-    std::cout << "Writing rewards to files..." << std::endl;
-    std::ofstream ofs("./rewards.txt");
-    if (!ofs.is_open()) {
-      std::cerr << "Failed to open ./rewards.txt for writing" << std::endl;
-      return 4;
-    }
-    for (const auto &r : rewards) {
-      ofs << r << std::endl;
-    }
-    ofs.close();
-  }
-  {
-    std::cout << "Writing states to files..." << std::endl;
-    std::ofstream ofs("./states.txt");
-    if (!ofs.is_open()) {
-      std::cerr << "Failed to open ./states.txt for writing" << std::endl;
-      return 5;
-    }
-    for (const auto &r : positions) {
-      ofs << r[0] << "," << r[1] << std::endl;
-    }
-    ofs.close();
-  }
+  trajectory.Flush();
+  std::cout << "Recorded " << trajectory.Steps() << " steps." << std::endl;
   agent.GetModel().OutputModel("./trained_model.txt");
 
   return 0;
@@ -1,5 +1,6 @@
 // #include <torch_agents.h>
 #include <torch_agents.h>
+#include <trajectory_recorder.h>
 
 #include <cassert>
 #include <fstream>
@@ -11,9 +12,16 @@ constexpr int nstates = nrows * ncols;
 constexpr int nstate_dim = 5;
 constexpr int nactions = 4;
 
+// -DRLLIB_FLOAT32 trains and acts in float32
+#ifdef RLLIB_FLOAT32
+using Feature = float;
+#else
+using Feature = double;
+#endif
+
 using Direction = std::array<int, 2>;
 using Agent =
-    RLlib::OffPolicyQNetSarsaAgent<nstate_dim, nactions, Direction, double>;
+    RLlib::OffPolicyQNetSarsaAgent<nstate_dim, nactions, Direction, Feature>;
 using State = typename Agent::State;
 using Position = std::array<int, 2>;
 using ActionsList = Agent::ActionsList;
@@ -55,13 +63,14 @@ int main(int, char **argv) {
 
   auto pos = Position{0, 0};
 
-  std::vector<double> rewards(Nstep, 0.0);
-  std::vector<Position> positions(Nstep, {{}});
+  // streamed in fixed-size chunks: memory does not grow with Nstep
+  RLlib::TrajectoryRecorder trajectory(
+      config.value("trajectory", json::object()), 2);
   auto features = [](const Position &s) {
-    return State{static_cast<double>(s[0]), static_cast<double>(s[1]),
-                 static_cast<double>(s[0] * s[0]),
-                 static_cast<double>(s[1] * s[1]),
-                 static_cast<double>(s[1] * s[0])};
+    return State{static_cast<Feature>(s[0]), static_cast<Feature>(s[1]),
+                 static_cast<Feature>(s[0] * s[0]),
+                 static_cast<Feature>(s[1] * s[1]),
+                 static_cast<Feature>(s[1] * s[0])};
   };
   std::cout << "Initialization complete, run for " << Nstep << " steps."
             << std::endl;
@@ -77,8 +86,7 @@ int main(int, char **argv) {
     // agent.SetLearningRate(0.1 / (step + 1) + 0.001);
     auto reward = pos_values[loc(pos)];
 
-    rewards[step] = reward;
-    positions[step] = pos;
+    trajectory.Record(reward, {pos[0], pos[1]});
     agent.CollectReward(reward);
     // agent.GetModel().OutputModel("./intermediate_model.txt", ',',
     //                              step == 0 ? false : true);
@@ -86,30 +94,8 @@ int main(int, char **argv) {
 
   std::cout << "Finished " << Nstep << " steps." << std::endl;
 
-  {
-    std::cout << "Writing rewards to files..." << std::endl;
-    std::ofstream ofs("./rewards.txt");
-    if (!ofs.is_open()) {
-      std::cerr << "Failed to open ./rewards.txt for writing" << std::endl;
-      return 4;
-    }
-    for (const auto &r : rewards) {
-      ofs << r << std::endl;
-    }
-    ofs.close();
-  }
-  {
-    std::cout << "Writing states to files..." << std::endl;
-    std::ofstream ofs("./states.txt");
-    if (!ofs.is_open()) {
-      std::cerr << "Failed to open ./states.txt for writing" << std::endl;
-      return 5;
-    }
-    for (const auto &r : positions) {
-      ofs << r[0] << "," << r[1] << std::endl;
-    }
-    ofs.close();
-  }
+  trajectory.Flush();
+  std::cout << "Recorded " << trajectory.Steps() << " steps." << std::endl;
   agent.GetModel().OutputModel("./trained_model.txt");
 
   return 0;
@@ -0,0 +1,19 @@
+#include <snapshot_writer.h>
+
+#include <iostream>
+
+// Converts a model snapshot stream to CSV on stdout: one line per snapshot,
+// the step followed by the row-major parameters.
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <snapshot file>" << std::endl;
+    return 1;
+  }
+  RLlib::ReadSnapshots<double>(
+      argv[1], [](std::uint64_t step, std::span<const double> parameters) {
+        std::cout << step;
+        for (double p : parameters) std::cout << "," << p;
+        std::cout << "\n";
+      });
+  return 0;
+}
@@ -0,0 +1,19 @@
+#include <trajectory_recorder.h>
+
+#include <iostream>
+
+// Converts a recorded trajectory to CSV on stdout: one line per step, the
+// reward followed by the state entries.
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <trajectory file>" << std::endl;
+    return 1;
+  }
+  RLlib::ReadTrajectory(
+      argv[1], [](double reward, std::span<const std::int32_t> state) {
+        std::cout << reward;
+        for (auto s : state) std::cout << "," << s;
+        std::cout << "\n";
+      });
+  return 0;
+}
@@ -1,7 +1,8 @@
 #ifndef TRAINER_H
 #define TRAINER_H
 
-#include <extern/tinyexpr.h>
+#include <random_generator.h>
+#include <schedule.h>
 
 #include <extern/json.hpp>
 #include <iostream>
@@ -41,48 +42,42 @@ class AgentBase {
 
   AgentBase(const json &config = {}) {
     static_assert(CAgent<TDerived>, "TDerived must satisfy the CAgent concept");
+    // seed first so the model's random initialisation is reproducible too
+    if (config.contains("seed")) {
+      rng_util::seed(config["seed"].get<uint64_t>());
+    }
     if (config.contains("learning_rates")) {
-      if (config["learning_rates"].is_array()) {
-        learning_rates_ = config["learning_rates"].get<std::vector<double>>();
-      } else if (config["learning_rates"].is_string()) {
+      if (config["learning_rates"].is_string()) {
         std::cout << "Using learning_rates formula: "
                   << config["learning_rates"].get<std::string>() << std::endl;
-        learning_rates_formula_ = config["learning_rates"].get<std::string>();
-      } else {
-        throw std::runtime_error(
-            "Invalid learning_rates format in config JSON");
       }
+      learning_rates_ = Schedule(config["learning_rates"]);
     }
   }
 
   const Action &UpdateState(const State &state) {
     state_ = state;
     ++round_;
-    if (learning_rates_.size() != 0) {
-      Derived().SetLearningRate(learning_rates_[std::min(
-          static_cast<size_t>(round_), learning_rates_.size() - 1)]);
-    } else if (!learning_rates_formula_.empty()) {
-      double round_double = static_cast<double>(round_);
-      te_variable vars[] = {{"round", &round_double}};
-      int err;
-      te_expr *expr =
-          te_compile(learning_rates_formula_.c_str(), vars, 1, &err);
-      if (expr) {
-        double lr = te_eval(expr);
-        Derived().SetLearningRate(lr);
-        te_free(expr);
-      } else {
-        throw std::runtime_error(
-            "Failed to parse learning_rates formula at "
-            "position " +
-            std::to_string(err));
-      }
+    if (!learning_rates_.Empty()) {
+      Derived().SetLearningRate(learning_rates_.Value(round_));
     }
     Derived().UpdateStateImpl();
 
     return action_;
   }
 
+  // Batched counterpart of UpdateState for N environment copies stepped in
+  // lockstep; one call advances the round once for all of them.
+  const std::vector<Action> &UpdateStates(const std::vector<State> &states) {
+    ++round_;
+    if (!learning_rates_.Empty()) {
+      Derived().SetLearningRate(learning_rates_.Value(round_));
+    }
+    Derived().UpdateStatesImpl(states);
+
+    return actions_;
+  }
+
   void ResetRound() { round_ = 0; }
 
   bool CollectReward(const Reward &reward, int round = -1) {
@@ -91,26 +86,33 @@ class AgentBase {
     return true;
   }
 
+  bool CollectRewards(const std::vector<Reward> &rewards, int round = -1) {
+    if (round != round_ && round != -1) return false;
+    rewards_ = rewards;
+    return true;
+  }
+
   void SetLearningRates(const std::vector<double> &learning_rates) {
-    learning_rates_ = learning_rates;
+    learning_rates_ = Schedule(learning_rates);
   }
 
-  void SetLearningRates(std::vector<double> &&learning_rates) {
-    learning_rates_ = learning_rates;
+  void SetLearningRateSchedule(Schedule schedule) {
+    learning_rates_ = std::move(schedule);
   }
 
-  void ResetLearningRates() { learning_rates_.clear(); }
+  void ResetLearningRates() { learning_rates_ = Schedule(); }
 
  protected:
   int round_ = 0;
   Reward reward_;
   Action action_;
   State state_;
+  std::vector<Reward> rewards_{};
+  std::vector<Action> actions_{};
 
  private:
   auto &Derived() { return static_cast<TDerived &>(*this); }
-  std::vector<double> learning_rates_{};
-  std::string learning_rates_formula_{};
+  Schedule learning_rates_{};
 };
 
 }  // namespace RLlib
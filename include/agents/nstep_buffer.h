@@ -0,0 +1,143 @@
+#ifndef AGENTS_NSTEP_BUFFER_H
+#define AGENTS_NSTEP_BUFFER_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace RLlib {
+
+// Sliding window of the last n (state, action, reward) steps of one
+// environment, kept in a ring, with the discounted reward sum
+// r_1 + gamma r_2 + ... + gamma^(m-1) r_m of the window maintained in
+// amortized O(1) per step whatever n is.
+//
+// The sum is not updated by subtracting the oldest reward and dividing by
+// gamma: that amplifies rounding error by 1/gamma every step and breaks for
+// gamma = 0. Instead the window is split in two (the "two stacks" sliding
+// window aggregation): older steps carry precomputed suffix sums, newer ones
+// a running sum, and when the older part runs out the newer part is folded
+// into suffix sums in one pass. Every reward is folded at most once.
+template <typename TState>
+class NStepBuffer {
+ public:
+  struct Step {
+    TState state{};
+    int action{-1};
+    double reward{};
+  };
+
+  NStepBuffer() = default;
+
+  void Reset(std::size_t n, double gamma) {
+    if (n == 0) {
+      throw std::runtime_error("steps must be > 0");
+    }
+    steps_.assign(n, Step{});
+    suffix_.assign(n, 0.0);
+    Clear();
+    SetGamma(gamma);
+  }
+
+  // Recomputes the powers of gamma and the sum of the current window, O(n).
+  void SetGamma(double gamma) {
+    gamma_ = gamma;
+    pows_.resize(steps_.size() + 1);
+    pows_[0] = 1.0;
+    for (std::size_t k = 1; k < pows_.size(); ++k) {
+      pows_[k] = pows_[k - 1] * gamma;
+    }
+    const std::size_t rewarded = Rewarded();
+    front_left_ = 0;
+    back_len_ = 0;
+    back_sum_ = 0.0;
+    for (std::size_t i = 0; i < rewarded; ++i) {
+      back_sum_ += pows_[back_len_++] * At(i).reward;
+    }
+  }
+
+  void Clear() {
+    head_ = 0;
+    size_ = 0;
+    front_left_ = 0;
+    back_len_ = 0;
+    back_sum_ = 0.0;
+  }
+
+  std::size_t Capacity() const { return steps_.size(); }
+  double Gamma() const { return gamma_; }
+  std::size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+
+  // Every slot holds a step whose reward has arrived.
+  bool Ready() const { return Rewarded() == steps_.size(); }
+
+  // gamma^n, the discount of the bootstrap value.
+  double Discount() const { return pows_.back(); }
+
+  // Appends a step whose reward is still to come; the window must not be
+  // full.
+  void Push(const TState &state, int action) {
+    auto &step = steps_[(head_ + size_) % steps_.size()];
+    step.state = state;
+    step.action = action;
+    ++size_;
+  }
+
+  // The reward that followed the newest step.
+  void AddReward(double reward) {
+    At(size_ - 1).reward = reward;
+    back_sum_ += pows_[back_len_++] * reward;
+  }
+
+  const Step &Oldest() const { return steps_[head_]; }
+
+  // Discounted sum of the rewards in the window, oldest first.
+  double Return() const {
+    if (front_left_ == 0) return back_sum_;
+    return suffix_[head_] + pows_[front_left_] * back_sum_;
+  }
+
+  void PopOldest() {
+    if (front_left_ == 0) Fold();
+    head_ = (head_ + 1) % steps_.size();
+    --size_;
+    --front_left_;
+  }
+
+ private:
+  std::size_t Rewarded() const { return front_left_ + back_len_; }
+
+  Step &At(std::size_t i) { return steps_[(head_ + i) % steps_.size()]; }
+  const Step &At(std::size_t i) const {
+    return steps_[(head_ + i) % steps_.size()];
+  }
+
+  // Turns the running part into suffix sums; only called once the
+  // precomputed part is used up, so the running part starts at the oldest
+  // step.
+  void Fold() {
+    double acc = 0.0;
+    for (std::size_t i = back_len_; i-- > 0;) {
+      acc = At(i).reward + gamma_ * acc;
+      suffix_[(head_ + i) % steps_.size()] = acc;
+    }
+    front_left_ = back_len_;
+    back_len_ = 0;
+    back_sum_ = 0.0;
+  }
+
+  std::vector<Step> steps_;
+  std::vector<double> suffix_;
+  std::vector<double> pows_{1.0};
+  double gamma_{1.0};
+  std::size_t head_{0};
+  std::size_t size_{0};
+  std::size_t front_left_{0};
+  std::size_t back_len_{0};
+  double back_sum_{0.0};
+};
+
+}  // namespace RLlib
+
+#endif  // AGENTS_NSTEP_BUFFER_H
@@ -1,10 +1,14 @@
 #ifndef AGENTS_SARSA_H
 #define AGENTS_SARSA_H
 #include <agent.h>
+#include <agents/nstep_buffer.h>
 #include <models/linear.h>
 #include <models/tabular.h>
 
+#include <algorithm>
 #include <extern/json.hpp>
+#include <memory>
+#include <type_traits>
 
 #include "random_generator.h"
 
@@ -21,9 +25,16 @@ inline json load_json(std::string_view filename) {
   f >> j;
   return j;
 }
-enum class SarsaTrainingMode { kOnPolicy = 0, kQLearning = 1, kModesCount = 2 };
+enum class SarsaTrainingMode {
+  kOnPolicy = 0,
+  kQLearning = 1,
+  kExpectedSarsa = 2,
+  kDoubleQ = 3,
+  kModesCount = 4
+};
 
-constexpr const char *SarsaTrainingModeNames[] = {"on_policy", "q_learning"};
+constexpr const char *SarsaTrainingModeNames[] = {"on_policy", "q_learning",
+                                                  "expected_sarsa", "double_q"};
 
 inline enum SarsaTrainingMode NameToMode(std::string_view name) {
   for (int i = 0; i < static_cast<int>(SarsaTrainingMode::kModesCount); ++i) {
@@ -46,15 +57,15 @@ class SarsaAgent : public AgentBase<SarsaAgent<TModel, TAction, TReward>,
   using Action = TAction;
   using ActionsList = std::array<Action, kActionsDim>;
   using Reward = TReward;
+  using ResultsList = typename Model::ResultsList;
 
   template <typename... TArgs>
   SarsaAgent(const ActionsList &actions, double epsilon, double gamma,
              TArgs &&...args)
-      : actions_(actions),
+      : model_(std::forward<TArgs>(args)...),
+        actions_(actions),
         epsilon_(epsilon),
-        gamma_(gamma),
-        current_gamma_(1.0),
-        model_(std::forward<TArgs>(args)...) {
+        gamma_(gamma) {
     static_assert(CModel<TModel>, "TModel must satisfy the CModel concept");
   }
 
@@ -62,36 +73,273 @@ class SarsaAgent : public AgentBase<SarsaAgent<TModel, TAction, TReward>,
       : SarsaAgent(actions, load_json(config_file)) {}
 
   SarsaAgent(const ActionsList &actions, const json &config)
+      : SarsaAgent(ModelArg{}, actions, config, config["model"]) {}
+
+  // Like the config constructor, but the model is a copy of `model` instead
+  // of being built from config["model"]. With models whose copies share
+  // their parameters (HogwildLinearModel, HogwildTabular) this puts several
+  // agents, e.g. one per thread, on one set of weights.
+  SarsaAgent(const ActionsList &actions, const json &config,
+             const Model &model)
+      : SarsaAgent(ModelArg{}, actions, config, model) {}
+
+  void UpdateStateImpl() {
+#ifdef DEBUG
+    std::cout << Base::round_ << ":" << std::endl;
+#endif
+    // copy: the model may overwrite its result buffer during Update()
+    ResultsList action_values = model_.GetActionValues(Base::state_);
+    if (second_model_) {
+      AddValues(action_values, second_model_->GetActionValues(Base::state_));
+    }
+    Base::action_ = actions_[StepLane(lanes_[0], Base::state_, action_values,
+                                      Base::reward_)];
+  }
+
+  // One step of N independent environment copies: a single batched forward
+  // through the model, then action selection and n-step bookkeeping per lane.
+  // Changing the number of lanes restarts every lane's bookkeeping.
+  void UpdateStatesImpl(const std::vector<State> &states) {
+    const std::size_t N = states.size();
+    if (N > 1 && HasTraces()) {
+      // one trace set per model, so lanes would share credit
+      throw std::runtime_error("eligibility_traces need a single lane");
+    }
+    if (lanes_.size() != N) {
+      lanes_.assign(N, Lane{});
+    }
+    if (Base::rewards_.size() != N) {
+      Base::rewards_.resize(N, Reward{});
+    }
+    Base::actions_.resize(N);
+    const auto &values = ActingBatchValues(states);
+    for (std::size_t n = 0; n < N; ++n) {
+      Base::actions_[n] = actions_[StepLane(lanes_[n], states[n], values[n],
+                                            Base::rewards_[n])];
+    }
+  }
+
+  void SetEpsilon(double epsilon) { epsilon_ = epsilon; }
+
+  void SetGamma(double gamma) { gamma_ = gamma; }
+
+  void SetLearningRate(double alpha) {
+    model_.SetLearningRate(alpha);
+    if (second_model_) second_model_->SetLearningRate(alpha);
+  }
+
+  auto &GetModel() { return model_; }
+
+  // Takes effect on the next step; lanes restart their n-step windows.
+  void SetSteps(size_t steps) {
+    CheckSettings(training_mode_, steps);
+    steps_ = steps;
+  }
+
+  // Leaving double_q drops the second estimate, so acting goes back to
+  // Q_A alone.
+  void SetTrainingMode(SarsaTrainingMode mode) {
+    CheckSettings(mode, steps_);
+    training_mode_ = mode;
+    if (mode != SarsaTrainingMode::kDoubleQ) {
+      second_model_.reset();
+    } else if (!second_model_) {
+      MakeSecondModel();
+    }
+  }
+
+  // The second value estimate of double_q mode, null otherwise.
+  Model *GetSecondModel() { return second_model_.get(); }
+
+ private:
+  struct ModelArg {};
+
+  // model_arg is the model's config or a model to copy
+  template <typename TModelArg>
+  SarsaAgent(ModelArg, const ActionsList &actions, const json &config,
+             const TModelArg &model_arg)
       : Base(config),
+        model_(model_arg),
         actions_(actions),
         epsilon_(config["epsilon"]),
         gamma_(config.value("gamma", 1.0)),
         steps_(config.value("steps", 1)),
+        debug_output_(config.value("debug_output", false)),
         training_mode_(NameToMode(config.value("training_mode", "on_policy"))),
-        current_gamma_(1.0),
-        model_(config["model"]),
-        debug_output_(config.value("debug_output", false)) {
+        model_config_(config["model"]) {
     static_assert(CModel<TModel>, "TModel must satisfy the CModel concept");
+    CheckSettings(training_mode_, steps_);
+    if (training_mode_ == SarsaTrainingMode::kDoubleQ) MakeSecondModel();
   }
 
-  void UpdateStateImpl() {
+  // Throws on a training mode and step count the model cannot train with.
+  void CheckSettings(SarsaTrainingMode mode, size_t steps) const {
+    if (HasTraces() && (steps != 1 || mode == SarsaTrainingMode::kDoubleQ)) {
+      throw std::runtime_error(
+          "eligibility_traces need steps == 1 and a single-estimate mode");
+    }
+    // the model bootstraps with max / double-DQN targets itself
+    if (RecomputesTargets() && mode != SarsaTrainingMode::kQLearning) {
+      throw std::runtime_error(
+          "replay_targets dqn and double_dqn need training_mode q_learning");
+    }
+  }
+
+  // n-step bookkeeping of one environment copy: its last steps_ steps
+  using Lane = NStepBuffer<State>;
+  using Step = typename Lane::Step;
+
+  const std::vector<ResultsList> &BatchActionValues(
+      Model &model, const std::vector<State> &states) {
+    if constexpr (requires { model.GetBatchActionValues(states); }) {
+      return model.GetBatchActionValues(states);
+    } else {
+      batch_values_.resize(states.size());
+      for (std::size_t n = 0; n < states.size(); ++n) {
+        batch_values_[n] = model.GetActionValues(states[n]);
+      }
+      return batch_values_;
+    }
+  }
+
+  // Values the policy acts on: Q_A + Q_B in double_q mode.
+  const std::vector<ResultsList> &ActingBatchValues(
+      const std::vector<State> &states) {
+    if (!second_model_) return BatchActionValues(model_, states);
+    combined_values_ = BatchActionValues(model_, states);
+    const auto &second = BatchActionValues(*second_model_, states);
+    for (std::size_t n = 0; n < states.size(); ++n) {
+      AddValues(combined_values_[n], second[n]);
+    }
+    return combined_values_;
+  }
+
+  static void AddValues(ResultsList &values, const ResultsList &other) {
+    for (int i = 0; i < kActionsDim; ++i) values[i] += other[i];
+  }
+
+  // Double Q-learning needs a second, independently updated estimate built
+  // like the first; it gets no gradient dump of its own.
+  void MakeSecondModel() {
+    if (!model_config_.is_null()) {
+      json config = model_config_;
+      config.erase("save_grad");
+      second_model_ = std::make_unique<Model>(config);
+    } else if constexpr (std::is_copy_constructible_v<Model>) {
+      second_model_ = std::make_unique<Model>(model_);
+    } else {
+      throw std::runtime_error("double_q needs an agent built from a config");
+    }
+  }
+
+  // Value of the next state used in the TD target. Models with a target
+  // network bootstrap from it instead of from the values used for acting.
+  double BootstrapValue(const State &state, const ResultsList &action_values,
+                        int idx_best, int idx_result) {
+    const ResultsList *values = &action_values;
+    if constexpr (requires { model_.GetTargetActionValues(state); }) {
+      if (model_.HasTargetNetwork()) {
+        values = &model_.GetTargetActionValues(state);
+      }
+    }
+    switch (training_mode_) {
+      case SarsaTrainingMode::kQLearning:
+        return *std::max_element(values->begin(), values->end());
+      case SarsaTrainingMode::kExpectedSarsa:
+        return ExpectedValue(*values, idx_best);
+      default:
+        return (*values)[idx_result];
+    }
+  }
+
+  // Expectation of values under the epsilon-greedy policy: the greedy action
+  // with probability 1 - epsilon, otherwise one of the others uniformly.
+  double ExpectedValue(const ResultsList &values, int idx_best) const {
+    if constexpr (kActionsDim == 1) {
+      return values[0];
+    } else {
+      double sum = 0.0;
+      for (int i = 0; i < kActionsDim; ++i) sum += values[i];
+      const double best = values[idx_best];
+      return (1.0 - epsilon_) * best +
+             epsilon_ * (sum - best) / (kActionsDim - 1);
+    }
+  }
+
+  // Double Q-learning: a coin flip picks the estimate to update; its greedy
+  // action in the next state is evaluated by the other estimate.
+  void DoubleQUpdate(const Step &step, double n_step_return,
+                     const State &state, double discount) {
+    const bool flip = rng_util::uniform01() < 0.5;
+    Model &learner = flip ? *second_model_ : model_;
+    Model &evaluator = flip ? model_ : *second_model_;
+    const auto &learner_values = learner.GetActionValues(state);
+    const auto idx_greedy = static_cast<int>(
+        std::max_element(learner_values.begin(), learner_values.end()) -
+        learner_values.begin());
+    const double value = evaluator.GetActionValues(state)[idx_greedy];
+    learner.Update(step.state, step.action, n_step_return + discount * value);
+  }
+
+  // Models that recompute targets at train time (e.g. DQN replay) take the
+  // raw n-step transition instead of a TD target.
+  bool RecomputesTargets() const {
+    if constexpr (requires { model_.RecomputesTargets(); }) {
+      return model_.RecomputesTargets();
+    } else {
+      return false;
+    }
+  }
+
+  void UpdateTransition(const Step &step, double n_step_return,
+                        const State &state, double discount) {
+    if constexpr (requires {
+                    model_.UpdateTransition(state, 0, 0.0, state, 0.0, false);
+                  }) {
+      model_.UpdateTransition(step.state, step.action, n_step_return, state,
+                              discount, false);
+    }
+  }
+
+  bool HasTraces() const {
+    if constexpr (requires { model_.HasTraces(); }) {
+      return model_.HasTraces();
+    } else {
+      return false;
+    }
+  }
+
+  // TD(lambda) through the model's eligibility traces when it keeps them.
+  // Watkins' Q(lambda) cuts the traces once the policy explores.
+  void UpdateModel(const Step &step, double td_target, bool explored) {
+    if constexpr (requires {
+                    model_.TraceUpdate(step.state, 0, 0.0, 0.0);
+                  }) {
+      if (model_.HasTraces()) {
+        model_.TraceUpdate(step.state, step.action, td_target, gamma_);
+        if (explored && training_mode_ == SarsaTrainingMode::kQLearning) {
+          model_.ClearTraces();
+        }
+        return;
+      }
+    }
+    model_.Update(step.state, step.action, td_target);
+  }
+
+  // Epsilon-greedy selection plus the n-step update for one lane; returns
+  // the index of the chosen action. Once the window holds n steps every call
+  // updates the oldest one with its n-step return
+  // r_1 + ... + gamma^(n-1) r_n + gamma^n V(state) and slides the window.
+  int StepLane(Lane &lane, const State &state,
+               const ResultsList &action_values, const Reward &reward) {
     int idx_best_ = 0;
-#ifdef DEBUG
-      std::cout << Base::round_ << ":" << std::endl;
-#endif
-    auto action_values = model_.GetActionValues(Base::state_);
     double max_value_ = action_values[0];
 
 #ifdef DEBUG
-      std::cout << "state = ";
-      for (const auto &s : Base::state_) {
-        std::cout << s << ",";
-      }
-      std::cout << std::endl;
-      std::cout << "action-value = ";
-      for (int i = 0; i < kActionsDim; ++i) {
-        std::cout << action_values[i] << ",";  // debug
-      }
+    std::cout << "action-value = ";
+    for (int i = 0; i < kActionsDim; ++i) {
+      std::cout << action_values[i] << ",";  // debug
+    }
 #endif
 
     for (int i = 1; i < kActionsDim; ++i) {
@@ -108,63 +356,47 @@ class SarsaAgent : public AgentBase<SarsaAgent<TModel, TAction, TReward>,
 
     if (rng_util::uniform01() < epsilon_) {
       int idx_random_ =
-          static_cast<int>(rng_util::uniform01() * (kActionsDim - 1));
+          static_cast<int>(rng_util::uniform_int(kActionsDim - 1));
       idx_result_ = idx_random_ < idx_best_ ? idx_random_ : idx_random_ + 1;
     } else {
       idx_result_ = idx_best_;
     }
-    Base::action_ = actions_[idx_result_];
-    double new_action_value{};
-    if (training_mode_ == SarsaTrainingMode::kQLearning) {
-      new_action_value = max_value_;
-    } else if (training_mode_ == SarsaTrainingMode::kOnPolicy) {
-      new_action_value = action_values[idx_result_];
+    if (lane.Capacity() != steps_) {
+      lane.Reset(steps_, gamma_);
+    } else if (lane.Gamma() != gamma_) {
+      lane.SetGamma(gamma_);
     }
-
-    if (Base::round_ % steps_ == 0) {
-      if (!is_first_round_) {
-        target_ += current_gamma_ * (Base::reward_ + gamma_ * new_action_value);
-        model_.Update(last_state_, last_action_idx_, target_);
-        target_ = 0.0;
+    if (!lane.Empty()) lane.AddReward(reward);
+    if (lane.Ready()) {
+      const Step &oldest = lane.Oldest();
+      if (RecomputesTargets()) {
+        UpdateTransition(oldest, lane.Return(), state, lane.Discount());
+      } else if (training_mode_ == SarsaTrainingMode::kDoubleQ) {
+        DoubleQUpdate(oldest, lane.Return(), state, lane.Discount());
       } else {
-        is_first_round_ = false;
+        const double bootstrap =
+            BootstrapValue(state, action_values, idx_best_, idx_result_);
+        UpdateModel(oldest, lane.Return() + lane.Discount() * bootstrap,
+                    action_values[idx_result_] < max_value_);
       }
-
-      last_state_ = Base::state_;
-      last_action_idx_ = idx_result_;
-      last_action_value_ = action_values[idx_result_];
-    } else {
-      target_ += current_gamma_ * Base::reward_;
-      current_gamma_ *= gamma_;
+      lane.PopOldest();
     }
+    lane.Push(state, idx_result_);
+    return idx_result_;
   }
 
-  void SetEpsilon(double epsilon) { epsilon_ = epsilon; }
-
-  void SetGamma(double gamma) { gamma_ = gamma; }
-
-  void SetLearningRate(double alpha) { model_.SetLearningRate(alpha); }
-
-  auto &GetModel() { return model_; }
-
-  void SetSteps(size_t steps) { steps_ = steps; }
-
-  void SetTrainingMode(SarsaTrainingMode mode) { training_mode_ = mode; }
-
- private:
   Model model_;
   const ActionsList actions_;
   double epsilon_;
-  State last_state_{};
-  int last_action_idx_ = -1;
-  double last_action_value_ = 0.0;
   double gamma_;
-  bool is_first_round_ = true;
-  double target_{};
   size_t steps_{1};
-  double current_gamma_{};
   bool debug_output_{};
   SarsaTrainingMode training_mode_{SarsaTrainingMode::kOnPolicy};
+  std::vector<Lane> lanes_{1};
+  std::vector<ResultsList> batch_values_{};
+  json model_config_{};
+  std::unique_ptr<Model> second_model_{};
+  std::vector<ResultsList> combined_values_{};
 };
 
 }  // namespace RLlib
@@ -0,0 +1,215 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Versioned binary checkpoints for the models' parameter matrices.
+//
+// Layout (native byte order): a 48-byte Header followed by rows * cols
+// elements of the recorded dtype, row-major. The file is written with a
+// single writev() and read back through mmap(), so loading is a header check,
+// a checksum pass and one memcpy into the model.
+namespace RLlib::Checkpoint {
+
+constexpr char kMagic[8] = {'R', 'L', 'C', 'K', 'P', 'T', '\0', '\0'};
+constexpr std::uint32_t kVersion = 1;
+
+enum class DType : std::uint32_t {
+  kFloat64 = 1,
+  kFloat32 = 2,
+  kInt32 = 3,
+  kInt64 = 4
+};
+
+template <typename T>
+constexpr DType DTypeOf() {
+  if constexpr (std::is_same_v<T, double>) {
+    return DType::kFloat64;
+  } else if constexpr (std::is_same_v<T, float>) {
+    return DType::kFloat32;
+  } else if constexpr (std::is_same_v<T, std::int32_t>) {
+    return DType::kInt32;
+  } else if constexpr (std::is_same_v<T, std::int64_t>) {
+    return DType::kInt64;
+  } else {
+    static_assert(sizeof(T) == 0, "Unsupported checkpoint element type");
+  }
+}
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t dtype;
+  std::uint64_t rows;
+  std::uint64_t cols;
+  std::uint64_t payload_bytes;
+  std::uint64_t checksum;
+};
+static_assert(sizeof(Header) == 48, "Checkpoint header must be 48 bytes");
+
+// FNV-1a over 64-bit words (bytes for the tail): cheap enough to run on every
+// load and catches truncation and bit rot.
+inline std::uint64_t Checksum(const void *data, std::size_t bytes) {
+  constexpr std::uint64_t kPrime = 0x100000001b3ull;
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+  const auto *p = static_cast<const unsigned char *>(data);
+  std::size_t i = 0;
+  for (; i + 8 <= bytes; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, p + i, 8);
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; i < bytes; ++i) {
+    hash = (hash ^ p[i]) * kPrime;
+  }
+  return hash;
+}
+
+template <typename T>
+void Save(std::string_view fname, std::uint64_t rows, std::uint64_t cols,
+          const T *data) {
+  const std::size_t bytes = rows * cols * sizeof(T);
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.dtype = static_cast<std::uint32_t>(DTypeOf<T>());
+  header.rows = rows;
+  header.cols = cols;
+  header.payload_bytes = bytes;
+  header.checksum = Checksum(data, bytes);
+
+  const std::string path(fname);
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open checkpoint for writing: " + path);
+  }
+  iovec iov[2] = {{&header, sizeof(header)},
+                  {const_cast<T *>(data), bytes}};
+  iovec *pending = iov;
+  int count = 2;
+  // one writev normally suffices; loop in case the kernel writes less
+  while (count > 0) {
+    ssize_t written = ::writev(fd, pending, count);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      ::close(fd);
+      throw std::runtime_error("Error writing checkpoint: " + path);
+    }
+    auto left = static_cast<std::size_t>(written);
+    while (count > 0 && left >= pending->iov_len) {
+      left -= pending->iov_len;
+      ++pending;
+      --count;
+    }
+    if (count > 0) {
+      pending->iov_base = static_cast<char *>(pending->iov_base) + left;
+      pending->iov_len -= left;
+    }
+  }
+  if (::close(fd) != 0) {
+    throw std::runtime_error("Error closing checkpoint: " + path);
+  }
+}
+
+// Read-only memory mapping of a checkpoint with a validated header.
+class MappedFile {
+ public:
+  explicit MappedFile(std::string_view fname) : path_(fname) {
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open checkpoint: " + path_);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+      ::close(fd);
+      throw std::runtime_error("Checkpoint too small: " + path_);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    addr_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr_ == MAP_FAILED) {
+      addr_ = nullptr;
+      throw std::runtime_error("Failed to mmap checkpoint: " + path_);
+    }
+
+    const Header &h = GetHeader();
+    const char *error = nullptr;
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) {
+      error = "Not a checkpoint file: ";
+    } else if (h.version != kVersion) {
+      error = "Unsupported checkpoint version: ";
+    } else if (h.payload_bytes != size_ - sizeof(Header)) {
+      error = "Truncated checkpoint: ";
+    }
+    if (error) {
+      ::munmap(addr_, size_);
+      addr_ = nullptr;
+      throw std::runtime_error(error + path_);
+    }
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile() {
+    if (addr_) ::munmap(addr_, size_);
+  }
+
+  const Header &GetHeader() const {
+    return *static_cast<const Header *>(addr_);
+  }
+
+  const void *Payload() const {
+    return static_cast<const char *>(addr_) + sizeof(Header);
+  }
+
+  // Typed view of the payload after checking dtype, shape and checksum.
+  template <typename T>
+  const T *Data(std::uint64_t rows, std::uint64_t cols,
+                bool verify_checksum = true) const {
+    const Header &h = GetHeader();
+    if (h.dtype != static_cast<std::uint32_t>(DTypeOf<T>())) {
+      throw std::runtime_error("Checkpoint dtype mismatch: " + path_);
+    }
+    if (h.rows != rows || h.cols != cols) {
+      throw std::runtime_error(
+          "Checkpoint shape [" + std::to_string(h.rows) + "," +
+          std::to_string(h.cols) + "] does not match model [" +
+          std::to_string(rows) + "," + std::to_string(cols) + "]: " + path_);
+    }
+    if (verify_checksum &&
+        Checksum(Payload(), h.payload_bytes) != h.checksum) {
+      throw std::runtime_error("Checkpoint checksum mismatch: " + path_);
+    }
+    return static_cast<const T *>(Payload());
+  }
+
+ private:
+  std::string path_;
+  void *addr_{nullptr};
+  std::size_t size_{0};
+};
+
+template <typename T>
+void Load(std::string_view fname, std::uint64_t rows, std::uint64_t cols,
+          T *data) {
+  MappedFile file(fname);
+  std::memcpy(data, file.Data<T>(rows, cols), rows * cols * sizeof(T));
+}
+
+}  // namespace RLlib::Checkpoint
+
+#endif  // CHECKPOINT_H
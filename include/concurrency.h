@@ -0,0 +1,181 @@
+#ifndef CONCURRENCY_H
+#define CONCURRENCY_H
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace RLlib {
+
+constexpr std::size_t kCacheLineSize = 64;
+
+// Bounded lock-free single-producer/single-consumer ring buffer. Each side
+// caches the other side's index so the shared atomics are only re-read when
+// the queue looks full (producer) or empty (consumer).
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(std::size_t capacity) {
+    if (capacity == 0) {
+      throw std::runtime_error("SpscQueue capacity must be > 0");
+    }
+    std::size_t rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+    buffer_.resize(rounded);
+    mask_ = rounded - 1;
+  }
+
+  bool TryPush(const T &value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ == buffer_.size()) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ == buffer_.size()) return false;
+    }
+    buffer_[head & mask_] = value;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T &value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail == cached_head_) return false;
+    }
+    value = buffer_[tail & mask_];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::size_t Capacity() const { return buffer_.size(); }
+
+  std::size_t SizeApprox() const {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::vector<T> buffer_;
+  std::size_t mask_{0};
+  alignas(kCacheLineSize) std::atomic<std::size_t> head_{0};
+  std::size_t cached_tail_{0};
+  alignas(kCacheLineSize) std::atomic<std::size_t> tail_{0};
+  std::size_t cached_head_{0};
+};
+
+// Index bookkeeping of a lock-free triple buffer with one writer and one
+// reader. The writer fills Back() and calls Publish(); the reader calls
+// Acquire() to switch Front() to the most recently published slot. Neither
+// side ever waits for the other.
+class TripleBufferIndex {
+ public:
+  int Back() const { return back_; }
+
+  void Publish() {
+    back_ = middle_.exchange(static_cast<std::uint8_t>(back_ | kDirty),
+                             std::memory_order_acq_rel) &
+            kIndexMask;
+  }
+
+  // Returns true if a new slot was picked up.
+  bool Acquire() {
+    if (!(middle_.load(std::memory_order_relaxed) & kDirty)) return false;
+    front_ = middle_.exchange(static_cast<std::uint8_t>(front_),
+                              std::memory_order_acq_rel) &
+             kIndexMask;
+    return true;
+  }
+
+  int Front() const { return front_; }
+
+ private:
+  static constexpr std::uint8_t kDirty = 0x4;
+  static constexpr std::uint8_t kIndexMask = 0x3;
+
+  alignas(kCacheLineSize) int front_{0};
+  std::atomic<std::uint8_t> middle_{1};
+  alignas(kCacheLineSize) int back_{2};
+};
+
+// Test-and-test-and-set spin lock on its own cache line, for critical
+// sections of a few dozen instructions. A waiter yields its time slice after
+// a while, in case the holder was preempted (more threads than cores).
+class alignas(kCacheLineSize) SpinLock {
+ public:
+  void lock() {
+    while (flag_.test_and_set(std::memory_order_acquire)) {
+      for (int spins = 0; flag_.test(std::memory_order_relaxed); ++spins) {
+        if (spins < kSpinsBeforeYield) {
+#if defined(__x86_64__) || defined(__i386__)
+          __builtin_ia32_pause();
+#endif
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  bool try_lock() { return !flag_.test_and_set(std::memory_order_acquire); }
+
+  void unlock() { flag_.clear(std::memory_order_release); }
+
+ private:
+  static constexpr int kSpinsBeforeYield = 128;
+
+  std::atomic_flag flag_{};
+};
+
+// A fixed set of spin locks that keys are hashed onto, so a large table can
+// be guarded by a few locks: two keys only contend if they share a stripe.
+class StripedLocks {
+ public:
+  explicit StripedLocks(std::size_t stripes) : locks_(stripes) {
+    if (stripes == 0) {
+      throw std::runtime_error("StripedLocks needs at least one stripe");
+    }
+  }
+
+  SpinLock &For(std::size_t key) { return locks_[key % locks_.size()]; }
+
+  std::size_t Size() const { return locks_.size(); }
+
+ private:
+  std::vector<SpinLock> locks_;
+};
+
+// CPUs this process may run on, in ascending order. If the affinity mask
+// cannot be read (e.g. more than CPU_SETSIZE CPUs) this falls back to
+// 0 .. hardware_concurrency() - 1; empty only if neither is known.
+inline std::vector<int> AvailableCpus() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  std::vector<int> cpus;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+  }
+  if (cpus.empty()) {
+    const int count = static_cast<int>(std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < count; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+// Restricts the calling thread to one CPU; returns false if the OS refused.
+inline bool PinCurrentThread(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+}  // namespace RLlib
+#endif  // CONCURRENCY_H
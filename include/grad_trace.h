@@ -0,0 +1,225 @@
+#ifndef GRAD_TRACE_H
+#define GRAD_TRACE_H
+
+#include <checkpoint.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <extern/json.hpp>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Binary gradient trace shared by the models' save_grad option.
+//
+// Stream layout: a Checkpoint::Header carrying kGradTraceMagic, then one
+// record per traced update: a RecordHeader followed by float64 columns
+// states[batch * features], actions[batch], last_q[batch], new_q[batch] and
+// grad[grad_elems]. Records are built in place in one of two arenas; when the
+// active arena fills up it is handed to a background thread that writes it
+// while the training thread carries on in the other one.
+namespace RLlib {
+
+constexpr char kGradTraceMagic[8] = {'R', 'L', 'G', 'R', 'A', 'D', '\0', '\0'};
+
+class GradTrace {
+ public:
+  struct RecordHeader {
+    std::uint64_t update;
+    std::uint32_t batch;
+    std::uint32_t features;
+    std::uint32_t grad_elems;
+    std::uint32_t reserved;
+  };
+  static_assert(sizeof(RecordHeader) % sizeof(double) == 0);
+
+  struct Record {
+    std::span<double> states;
+    std::span<double> actions;
+    std::span<double> last_q;
+    std::span<double> new_q;
+    std::span<double> grad;
+  };
+
+  // config is either `true` (trace every update to grad.bin) or an object
+  // with "file", "every" (trace every Nth update) and "buffer_bytes".
+  explicit GradTrace(const json &config)
+      : every_(config.is_object() ? config.value("every", std::uint64_t{1})
+                                  : 1) {
+    if (every_ == 0) {
+      throw std::runtime_error("save_grad every must be > 0");
+    }
+    const std::string fname = config.is_object()
+                                  ? config.value("file", kDefaultFile)
+                                  : kDefaultFile;
+    const std::size_t bytes =
+        config.is_object()
+            ? config.value("buffer_bytes", kDefaultBufferBytes)
+            : kDefaultBufferBytes;
+    for (auto &buffer : buffers_) buffer.resize(Words(bytes));
+
+    ofs_.open(fname, std::ios::binary | std::ios::trunc);
+    if (!ofs_.is_open()) {
+      throw std::runtime_error("Failed to open gradient trace: " + fname);
+    }
+    Checkpoint::Header header{};
+    std::memcpy(header.magic, kGradTraceMagic, sizeof(kGradTraceMagic));
+    header.version = Checkpoint::kVersion;
+    header.dtype = static_cast<std::uint32_t>(Checkpoint::DType::kFloat64);
+    ofs_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    thread_ = std::thread([this] { Run(); });
+  }
+
+  // Null unless the model config enables save_grad.
+  static std::unique_ptr<GradTrace> FromConfig(const json &model_config) {
+    if (!model_config.contains("save_grad")) return nullptr;
+    const auto &config = model_config["save_grad"];
+    if (config.is_boolean() && !config.get<bool>()) return nullptr;
+    return std::make_unique<GradTrace>(config);
+  }
+
+  GradTrace(const GradTrace &) = delete;
+  GradTrace &operator=(const GradTrace &) = delete;
+
+  ~GradTrace() {
+    if (used_ > 0) Handoff();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  // Counts one update; true if it should be recorded.
+  bool Sample() { return updates_++ % every_ == 0; }
+
+  // Space for one record in the active arena, valid until the next call.
+  Record Reserve(std::uint32_t batch, std::uint32_t features,
+                 std::uint32_t grad_elems) {
+    const std::size_t values =
+        static_cast<std::size_t>(batch) * (features + 3) + grad_elems;
+    const std::size_t words = Words(sizeof(RecordHeader)) + values;
+    if (used_ + words > buffers_[active_].size()) {
+      if (used_ > 0) Handoff();
+      if (words > buffers_[active_].size()) buffers_[active_].resize(words);
+    }
+    std::uint64_t *base = buffers_[active_].data() + used_;
+    used_ += words;
+
+    const RecordHeader header{updates_ - 1, batch, features, grad_elems, 0};
+    std::memcpy(base, &header, sizeof(header));
+    auto *values_ptr =
+        reinterpret_cast<double *>(base + Words(sizeof(RecordHeader)));
+    return SplitRecord(values_ptr, header);
+  }
+
+  static Record SplitRecord(double *values, const RecordHeader &header) {
+    Record record;
+    record.states = {values, std::size_t{header.batch} * header.features};
+    values += record.states.size();
+    record.actions = {values, header.batch};
+    record.last_q = {values + header.batch, header.batch};
+    record.new_q = {values + 2 * header.batch, header.batch};
+    record.grad = {values + 3 * header.batch, header.grad_elems};
+    return record;
+  }
+
+ private:
+  static constexpr const char *kDefaultFile = "grad.bin";
+  static constexpr std::size_t kDefaultBufferBytes = 1 << 20;
+
+  static std::size_t Words(std::size_t bytes) {
+    return (bytes + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+  }
+
+  // Passes the active arena to the writer, waiting only if the writer is
+  // still busy with the other one.
+  void Handoff() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return pending_words_ == 0; });
+    pending_ = active_;
+    pending_words_ = used_;
+    active_ ^= 1;
+    used_ = 0;
+    lock.unlock();
+    cv_.notify_all();
+  }
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      cv_.wait(lock, [this] { return pending_words_ > 0 || stop_; });
+      if (pending_words_ == 0) break;
+      const auto &buffer = buffers_[pending_];
+      const std::size_t words = pending_words_;
+      lock.unlock();
+      ofs_.write(reinterpret_cast<const char *>(buffer.data()),
+                 static_cast<std::streamsize>(words * sizeof(std::uint64_t)));
+      lock.lock();
+      pending_words_ = 0;
+      cv_.notify_all();
+    }
+    ofs_.flush();
+  }
+
+  std::uint64_t every_;
+  std::uint64_t updates_{0};
+  std::vector<std::uint64_t> buffers_[2];
+  int active_{0};
+  std::size_t used_{0};
+  std::ofstream ofs_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int pending_{1};
+  std::size_t pending_words_{0};
+  bool stop_{false};
+  std::thread thread_;
+};
+
+// Reads a gradient trace back, calling fn(header, record) for every record.
+inline void ReadGradTrace(
+    std::string_view fname,
+    const std::function<void(const GradTrace::RecordHeader &,
+                             const GradTrace::Record &)> &fn) {
+  std::ifstream ifs(std::string(fname), std::ios::binary);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("Failed to open gradient trace: " +
+                             std::string(fname));
+  }
+  Checkpoint::Header header{};
+  ifs.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!ifs || std::memcmp(header.magic, kGradTraceMagic,
+                          sizeof(kGradTraceMagic)) != 0) {
+    throw std::runtime_error("Not a gradient trace: " + std::string(fname));
+  }
+  GradTrace::RecordHeader record_header{};
+  std::vector<double> values;
+  while (ifs.read(reinterpret_cast<char *>(&record_header),
+                  sizeof(record_header))) {
+    values.resize(std::size_t{record_header.batch} *
+                      (record_header.features + 3) +
+                  record_header.grad_elems);
+    if (!ifs.read(reinterpret_cast<char *>(values.data()),
+                  static_cast<std::streamsize>(values.size() *
+                                               sizeof(double)))) {
+      throw std::runtime_error("Truncated gradient trace: " +
+                               std::string(fname));
+    }
+    fn(record_header, GradTrace::SplitRecord(values.data(), record_header));
+  }
+}
+
+}  // namespace RLlib
+
+#endif  // GRAD_TRACE_H
@@ -0,0 +1,388 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RLLIB_X86_SIMD 1
+#include <immintrin.h>
+#define RLLIB_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define RLLIB_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// Dense linear-algebra kernels for the hand-written models: dot product,
+// axpy and a fused multi-row dot product that evaluates all rows in a single
+// pass over x. double and float inputs are dispatched at runtime to AVX-512,
+// AVX2 or scalar code; any other element type takes the scalar path.
+namespace RLlib::Kernels {
+
+enum class SimdLevel { kScalar = 0, kAVX2 = 1, kAVX512 = 2, kLevelsCount = 3 };
+
+constexpr const char *SimdLevelNames[] = {"scalar", "avx2", "avx512"};
+
+inline SimdLevel DetectedSimdLevel() {
+#ifdef RLLIB_X86_SIMD
+  static const SimdLevel level = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::kAVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return SimdLevel::kAVX2;
+    }
+    return SimdLevel::kScalar;
+  }();
+  return level;
+#else
+  return SimdLevel::kScalar;
+#endif
+}
+
+// "auto" picks the best level the CPU supports; an explicit level is capped
+// at what the CPU supports.
+inline SimdLevel NameToSimdLevel(std::string_view name) {
+  if (name == "auto") return DetectedSimdLevel();
+  for (int i = 0; i < static_cast<int>(SimdLevel::kLevelsCount); ++i) {
+    if (name == SimdLevelNames[i]) {
+      return std::min(static_cast<SimdLevel>(i), DetectedSimdLevel());
+    }
+  }
+  throw std::runtime_error("Invalid SimdLevel name: " + std::string(name));
+}
+
+namespace detail {
+
+template <typename T>
+inline T DotScalar(const T *a, const T *b, int n) {
+  T sum{};
+  for (int j = 0; j < n; ++j) sum += a[j] * b[j];
+  return sum;
+}
+
+template <typename T>
+inline void AxpyScalar(T alpha, const T *x, T *y, int n) {
+  for (int j = 0; j < n; ++j) y[j] += alpha * x[j];
+}
+
+template <int tRows, typename T>
+inline void MultiDotScalar(const T *W, int stride, const T *x, int n,
+                           T *out) {
+  for (int r = 0; r < tRows; ++r) out[r] = DotScalar(W + r * stride, x, n);
+}
+
+#ifdef RLLIB_X86_SIMD
+RLLIB_TARGET_AVX2 inline double HorizontalSum(__m256d v) {
+  __m128d lo = _mm256_castpd256_pd128(v);
+  __m128d hi = _mm256_extractf128_pd(v, 1);
+  lo = _mm_add_pd(lo, hi);
+  return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+RLLIB_TARGET_AVX2 inline float HorizontalSum(__m256 v) {
+  __m128 lo = _mm256_castps256_ps128(v);
+  __m128 hi = _mm256_extractf128_ps(v, 1);
+  lo = _mm_add_ps(lo, hi);
+  lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+  return _mm_cvtss_f32(_mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1)));
+}
+
+RLLIB_TARGET_AVX2 inline double DotAVX2(const double *a, const double *b,
+                                        int n) {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j),
+                           acc0);
+    acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j + 4),
+                           _mm256_loadu_pd(b + j + 4), acc1);
+  }
+  for (; j + 4 <= n; j += 4) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j),
+                           acc0);
+  }
+  double sum = HorizontalSum(_mm256_add_pd(acc0, acc1));
+  for (; j < n; ++j) sum += a[j] * b[j];
+  return sum;
+}
+
+RLLIB_TARGET_AVX2 inline float DotAVX2(const float *a, const float *b,
+                                       int n) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  int j = 0;
+  for (; j + 16 <= n; j += 16) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(b + j),
+                           acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j + 8),
+                           _mm256_loadu_ps(b + j + 8), acc1);
+  }
+  for (; j + 8 <= n; j += 8) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(b + j),
+                           acc0);
+  }
+  float sum = HorizontalSum(_mm256_add_ps(acc0, acc1));
+  for (; j < n; ++j) sum += a[j] * b[j];
+  return sum;
+}
+
+RLLIB_TARGET_AVX2 inline void AxpyAVX2(double alpha, const double *x,
+                                       double *y, int n) {
+  const __m256d va = _mm256_set1_pd(alpha);
+  int j = 0;
+  for (; j + 4 <= n; j += 4) {
+    _mm256_storeu_pd(y + j, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + j),
+                                            _mm256_loadu_pd(y + j)));
+  }
+  for (; j < n; ++j) y[j] += alpha * x[j];
+}
+
+RLLIB_TARGET_AVX2 inline void AxpyAVX2(float alpha, const float *x, float *y,
+                                       int n) {
+  const __m256 va = _mm256_set1_ps(alpha);
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    _mm256_storeu_ps(y + j, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + j),
+                                            _mm256_loadu_ps(y + j)));
+  }
+  for (; j < n; ++j) y[j] += alpha * x[j];
+}
+
+template <int tRows>
+RLLIB_TARGET_AVX2 inline void MultiDotAVX2(const double *W, int stride,
+                                           const double *x, int n,
+                                           double *out) {
+  __m256d acc[tRows];
+  for (int r = 0; r < tRows; ++r) acc[r] = _mm256_setzero_pd();
+  int j = 0;
+  for (; j + 4 <= n; j += 4) {
+    const __m256d vx = _mm256_loadu_pd(x + j);
+    for (int r = 0; r < tRows; ++r) {
+      acc[r] = _mm256_fmadd_pd(_mm256_loadu_pd(W + r * stride + j), vx,
+                               acc[r]);
+    }
+  }
+  for (int r = 0; r < tRows; ++r) {
+    double sum = HorizontalSum(acc[r]);
+    for (int k = j; k < n; ++k) sum += W[r * stride + k] * x[k];
+    out[r] = sum;
+  }
+}
+
+template <int tRows>
+RLLIB_TARGET_AVX2 inline void MultiDotAVX2(const float *W, int stride,
+                                           const float *x, int n, float *out) {
+  __m256 acc[tRows];
+  for (int r = 0; r < tRows; ++r) acc[r] = _mm256_setzero_ps();
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    const __m256 vx = _mm256_loadu_ps(x + j);
+    for (int r = 0; r < tRows; ++r) {
+      acc[r] = _mm256_fmadd_ps(_mm256_loadu_ps(W + r * stride + j), vx,
+                               acc[r]);
+    }
+  }
+  for (int r = 0; r < tRows; ++r) {
+    float sum = HorizontalSum(acc[r]);
+    for (int k = j; k < n; ++k) sum += W[r * stride + k] * x[k];
+    out[r] = sum;
+  }
+}
+
+RLLIB_TARGET_AVX512 inline double DotAVX512(const double *a, const double *b,
+                                            int n) {
+  __m512d acc0 = _mm512_setzero_pd();
+  __m512d acc1 = _mm512_setzero_pd();
+  int j = 0;
+  for (; j + 16 <= n; j += 16) {
+    acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j),
+                           acc0);
+    acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + j + 8),
+                           _mm512_loadu_pd(b + j + 8), acc1);
+  }
+  for (; j + 8 <= n; j += 8) {
+    acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j),
+                           acc0);
+  }
+  if (j < n) {
+    const __mmask8 m = static_cast<__mmask8>((1u << (n - j)) - 1);
+    acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a + j),
+                           _mm512_maskz_loadu_pd(m, b + j), acc1);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+RLLIB_TARGET_AVX512 inline float DotAVX512(const float *a, const float *b,
+                                           int n) {
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  int j = 0;
+  for (; j + 32 <= n; j += 32) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + j), _mm512_loadu_ps(b + j),
+                           acc0);
+    acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + j + 16),
+                           _mm512_loadu_ps(b + j + 16), acc1);
+  }
+  for (; j + 16 <= n; j += 16) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + j), _mm512_loadu_ps(b + j),
+                           acc0);
+  }
+  if (j < n) {
+    const __mmask16 m = static_cast<__mmask16>((1u << (n - j)) - 1);
+    acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + j),
+                           _mm512_maskz_loadu_ps(m, b + j), acc1);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+RLLIB_TARGET_AVX512 inline void AxpyAVX512(double alpha, const double *x,
+                                           double *y, int n) {
+  const __m512d va = _mm512_set1_pd(alpha);
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    _mm512_storeu_pd(y + j, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + j),
+                                            _mm512_loadu_pd(y + j)));
+  }
+  if (j < n) {
+    const __mmask8 m = static_cast<__mmask8>((1u << (n - j)) - 1);
+    _mm512_mask_storeu_pd(
+        y + j, m,
+        _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + j),
+                        _mm512_maskz_loadu_pd(m, y + j)));
+  }
+}
+
+RLLIB_TARGET_AVX512 inline void AxpyAVX512(float alpha, const float *x,
+                                           float *y, int n) {
+  const __m512 va = _mm512_set1_ps(alpha);
+  int j = 0;
+  for (; j + 16 <= n; j += 16) {
+    _mm512_storeu_ps(y + j, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + j),
+                                            _mm512_loadu_ps(y + j)));
+  }
+  if (j < n) {
+    const __mmask16 m = static_cast<__mmask16>((1u << (n - j)) - 1);
+    _mm512_mask_storeu_ps(
+        y + j, m,
+        _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, x + j),
+                        _mm512_maskz_loadu_ps(m, y + j)));
+  }
+}
+
+template <int tRows>
+RLLIB_TARGET_AVX512 inline void MultiDotAVX512(const double *W, int stride,
+                                               const double *x, int n,
+                                               double *out) {
+  __m512d acc[tRows];
+  for (int r = 0; r < tRows; ++r) acc[r] = _mm512_setzero_pd();
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    const __m512d vx = _mm512_loadu_pd(x + j);
+    for (int r = 0; r < tRows; ++r) {
+      acc[r] = _mm512_fmadd_pd(_mm512_loadu_pd(W + r * stride + j), vx,
+                               acc[r]);
+    }
+  }
+  if (j < n) {
+    const __mmask8 m = static_cast<__mmask8>((1u << (n - j)) - 1);
+    const __m512d vx = _mm512_maskz_loadu_pd(m, x + j);
+    for (int r = 0; r < tRows; ++r) {
+      acc[r] = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, W + r * stride + j),
+                               vx, acc[r]);
+    }
+  }
+  for (int r = 0; r < tRows; ++r) out[r] = _mm512_reduce_add_pd(acc[r]);
+}
+
+template <int tRows>
+RLLIB_TARGET_AVX512 inline void MultiDotAVX512(const float *W, int stride,
+                                               const float *x, int n,
+                                               float *out) {
+  __m512 acc[tRows];
+  for (int r = 0; r < tRows; ++r) acc[r] = _mm512_setzero_ps();
+  int j = 0;
+  for (; j + 16 <= n; j += 16) {
+    const __m512 vx = _mm512_loadu_ps(x + j);
+    for (int r = 0; r < tRows; ++r) {
+      acc[r] = _mm512_fmadd_ps(_mm512_loadu_ps(W + r * stride + j), vx,
+                               acc[r]);
+    }
+  }
+  if (j < n) {
+    const __mmask16 m = static_cast<__mmask16>((1u << (n - j)) - 1);
+    const __m512 vx = _mm512_maskz_loadu_ps(m, x + j);
+    for (int r = 0; r < tRows; ++r) {
+      acc[r] = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, W + r * stride + j),
+                               vx, acc[r]);
+    }
+  }
+  for (int r = 0; r < tRows; ++r) out[r] = _mm512_reduce_add_ps(acc[r]);
+}
+#endif  // RLLIB_X86_SIMD
+
+template <typename T>
+constexpr bool kVectorizable =
+    std::is_same_v<T, double> || std::is_same_v<T, float>;
+
+}  // namespace detail
+
+template <typename T>
+inline T Dot(SimdLevel level, const T *a, const T *b, int n) {
+#ifdef RLLIB_X86_SIMD
+  if constexpr (detail::kVectorizable<T>) {
+    switch (level) {
+      case SimdLevel::kAVX512:
+        return detail::DotAVX512(a, b, n);
+      case SimdLevel::kAVX2:
+        return detail::DotAVX2(a, b, n);
+      default:
+        break;
+    }
+  }
+#endif
+  return detail::DotScalar(a, b, n);
+}
+
+// y += alpha * x
+template <typename T>
+inline void Axpy(SimdLevel level, T alpha, const T *x, T *y, int n) {
+#ifdef RLLIB_X86_SIMD
+  if constexpr (detail::kVectorizable<T>) {
+    switch (level) {
+      case SimdLevel::kAVX512:
+        return detail::AxpyAVX512(alpha, x, y, n);
+      case SimdLevel::kAVX2:
+        return detail::AxpyAVX2(alpha, x, y, n);
+      default:
+        break;
+    }
+  }
+#endif
+  detail::AxpyScalar(alpha, x, y, n);
+}
+
+// out[r] = dot(W[r * stride : r * stride + n], x) for r < tRows, reading x
+// once.
+template <int tRows, typename T>
+inline void MultiDot(SimdLevel level, const T *W, int stride, const T *x,
+                     int n, T *out) {
+#ifdef RLLIB_X86_SIMD
+  if constexpr (detail::kVectorizable<T>) {
+    switch (level) {
+      case SimdLevel::kAVX512:
+        return detail::MultiDotAVX512<tRows>(W, stride, x, n, out);
+      case SimdLevel::kAVX2:
+        return detail::MultiDotAVX2<tRows>(W, stride, x, n, out);
+      default:
+        break;
+    }
+  }
+#endif
+  detail::MultiDotScalar<tRows>(W, stride, x, n, out);
+}
+
+}  // namespace RLlib::Kernels
+
+#endif  // KERNELS_H
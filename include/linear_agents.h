@@ -1,6 +1,8 @@
 #ifndef LINEAR_AGENT_H
 #define LINEAR_AGENT_H
+#include <models/hogwild.h>
 #include <models/linear.h>
+#include <models/sparse_linear.h>
 
 #include "agents/sarsa.h"
 
@@ -11,5 +13,21 @@ using LinearSarsaAgent =
     SarsaAgent<Models::SimpleLinearModel<tFeaturesDim, tActionsDim, TFeature>,
                TAction, TReward>;
 
+// Agents built from copies of one model share its weights (Hogwild
+// training).
+template <int tFeaturesDim, int tActionsDim, typename TAction = double,
+          typename TFeature = double, typename TReward = double>
+using HogwildLinearSarsaAgent = SarsaAgent<
+    Models::HogwildLinearModel<tFeaturesDim, tActionsDim, TFeature>, TAction,
+    TReward>;
+
+// States are SparseState<tMaxActive>, e.g. from a TileCoder or
+// FeatureHasher.
+template <int tFeaturesDim, int tActionsDim, int tMaxActive,
+          typename TAction = double, typename TReward = double>
+using SparseLinearSarsaAgent = SarsaAgent<
+    Models::SparseLinearModel<tFeaturesDim, tActionsDim, tMaxActive>, TAction,
+    TReward>;
+
 } // RLlib
 #endif
\ No newline at end of file
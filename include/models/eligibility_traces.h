@@ -0,0 +1,119 @@
+#ifndef MODELS_ELIGIBILITY_TRACES_H
+#define MODELS_ELIGIBILITY_TRACES_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <extern/json.hpp>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace RLlib::Models {
+
+enum class TraceType { kAccumulating = 0, kReplacing = 1, kTypesCount = 2 };
+
+constexpr const char *TraceTypeNames[] = {"accumulating", "replacing"};
+
+inline TraceType NameToTraceType(std::string_view name) {
+  for (int i = 0; i < static_cast<int>(TraceType::kTypesCount); ++i) {
+    if (name == TraceTypeNames[i]) {
+      return static_cast<TraceType>(i);
+    }
+  }
+  throw std::runtime_error("Invalid TraceType name");
+}
+
+// Eligibility traces over a flat parameter index space, stored sparsely: a
+// dense value array plus the list of indices whose trace is live. Every step
+// visits only the live traces, and a trace that decays below the cutoff
+// leaves the list, so the per-step cost follows the recent trajectory rather
+// than the size of the table.
+class EligibilityTraces {
+ public:
+  // config keys: "lambda" (default 0.9), "type" ("accumulating" or
+  // "replacing", default accumulating), "cutoff" (default 1e-4)
+  EligibilityTraces(std::size_t size, const json &config)
+      : lambda_(config.value("lambda", 0.9)),
+        type_(NameToTraceType(config.value("type", "accumulating"))),
+        cutoff_(config.value("cutoff", 1e-4)),
+        traces_(size, 0.0),
+        slots_(size, kInactive) {
+    if (!(lambda_ >= 0.0 && lambda_ <= 1.0)) {
+      throw std::runtime_error("eligibility_traces lambda must be in [0, 1]");
+    }
+    if (!(cutoff_ >= 0.0)) {
+      throw std::runtime_error("eligibility_traces cutoff must be >= 0");
+    }
+  }
+
+  double Lambda() const { return lambda_; }
+
+  // Marks index as just visited with the given gradient component.
+  void Visit(std::size_t index, double amount = 1.0) {
+    if (slots_[index] == kInactive) {
+      slots_[index] = static_cast<std::uint32_t>(active_.size());
+      active_.push_back(static_cast<std::uint32_t>(index));
+      traces_[index] = amount;
+    } else if (type_ == TraceType::kReplacing) {
+      traces_[index] = amount;
+    } else {
+      traces_[index] += amount;
+    }
+  }
+
+  // Calls fn(index, trace) for every live trace, then decays them all by
+  // decay and drops those that fall below the cutoff.
+  template <typename TFunc>
+  void Apply(double decay, TFunc &&fn) {
+    for (std::size_t k = 0; k < active_.size();) {
+      const std::uint32_t index = active_[k];
+      fn(index, traces_[index]);
+      traces_[index] *= decay;
+      if (std::abs(traces_[index]) < cutoff_ || traces_[index] == 0.0) {
+        Drop(k);
+      } else {
+        ++k;
+      }
+    }
+  }
+
+  void Clear() {
+    for (std::uint32_t index : active_) {
+      traces_[index] = 0.0;
+      slots_[index] = kInactive;
+    }
+    active_.clear();
+  }
+
+  double Trace(std::size_t index) const { return traces_[index]; }
+
+  std::size_t ActiveCount() const { return active_.size(); }
+
+ private:
+  static constexpr std::uint32_t kInactive = UINT32_MAX;
+
+  // swap-remove the k-th live trace
+  void Drop(std::size_t k) {
+    const std::uint32_t index = active_[k];
+    const std::uint32_t last = active_.back();
+    active_[k] = last;
+    slots_[last] = static_cast<std::uint32_t>(k);
+    active_.pop_back();
+    traces_[index] = 0.0;
+    slots_[index] = kInactive;
+  }
+
+  double lambda_;
+  TraceType type_;
+  double cutoff_;
+  std::vector<double> traces_;
+  std::vector<std::uint32_t> slots_;
+  std::vector<std::uint32_t> active_;
+};
+
+}  // namespace RLlib::Models
+
+#endif  // MODELS_ELIGIBILITY_TRACES_H
@@ -0,0 +1,359 @@
+#ifndef MODELS_HOGWILD_H
+#define MODELS_HOGWILD_H
+#include <agent.h>
+#include <checkpoint.h>
+#include <concurrency.h>
+#include <kernels.h>
+#include <models/linear.h>
+#include <models/tabular.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RLlib::Models {
+
+// How concurrent updates of a shared Hogwild model are made safe.
+//  - kAtomic: lock-free. Every parameter is read and written with relaxed
+//    atomics, so there are no torn values, but a read-modify-write can be
+//    overwritten by another thread's (a lost update, as in Hogwild!).
+//  - kStriped: each row (an action's weights, or a stripe of states of a
+//    table) is guarded by a spin lock, so updates are exact and the linear
+//    model keeps its SIMD kernels, at the cost of contention on hot rows.
+enum class HogwildMode { kAtomic = 0, kStriped = 1, kModesCount = 2 };
+
+constexpr const char *HogwildModeNames[] = {"atomic", "striped"};
+
+inline HogwildMode NameToHogwildMode(std::string_view name) {
+  for (int i = 0; i < static_cast<int>(HogwildMode::kModesCount); ++i) {
+    if (name == HogwildModeNames[i]) {
+      return static_cast<HogwildMode>(i);
+    }
+  }
+  throw std::runtime_error("Invalid HogwildMode name");
+}
+
+// Row-major [rows, cols] parameters shared by every copy of a Hogwild model,
+// with the locks of the striped mode.
+template <typename T>
+class HogwildParameters {
+ public:
+  HogwildParameters(std::size_t rows, std::size_t cols, HogwildMode mode,
+                    std::size_t stripes)
+      : rows_(rows), cols_(cols), mode_(mode), data_(rows * cols),
+        locks_(stripes) {}
+
+  T *Row(std::size_t r) { return data_.data() + r * cols_; }
+  SpinLock &LockFor(std::size_t r) { return locks_.For(r); }
+  HogwildMode Mode() const { return mode_; }
+
+  static T Load(T &value) {
+    return std::atomic_ref<T>(value).load(std::memory_order_relaxed);
+  }
+  static void Store(T &value, T v) {
+    std::atomic_ref<T>(value).store(v, std::memory_order_relaxed);
+  }
+
+  // Not synchronized: for setup and for saving after the workers joined.
+  T *Data() { return data_.data(); }
+  const T *Data() const { return data_.data(); }
+
+  void Output(std::string_view fname, char delimiter, bool append) const {
+    std::ofstream ofs(fname.data(), append ? std::ios::app : std::ios::out);
+    if (!ofs.is_open()) {
+      throw std::runtime_error("Failed to open output file");
+    }
+    for (std::size_t r = 0; r < rows_; ++r) {
+      for (std::size_t c = 0; c < cols_; ++c) {
+        ofs << data_[r * cols_ + c];
+        if (c != cols_ - 1) {
+          ofs << ",";
+        }
+      }
+      if (r != rows_ - 1) {
+        ofs << delimiter;
+      }
+    }
+    ofs << '\n';
+  }
+
+  void Load(std::string_view fname, char delimiter) {
+    std::ifstream ifs(fname.data());
+    if (!ifs.is_open()) {
+      throw std::runtime_error("Failed to open input file");
+    }
+    for (std::size_t r = 0; r < rows_; ++r) {
+      for (std::size_t c = 0; c < cols_; ++c) {
+        ifs >> data_[r * cols_ + c];
+        if (ifs.peek() == ',') {
+          ifs.ignore();
+        }
+      }
+      if (ifs.peek() == delimiter) {
+        ifs.ignore();
+      }
+    }
+  }
+
+  void SaveCheckpoint(std::string_view fname) const {
+    Checkpoint::Save(fname, rows_, cols_, data_.data());
+  }
+
+  void LoadCheckpoint(std::string_view fname) {
+    Checkpoint::Load(fname, rows_, cols_, data_.data());
+  }
+
+ private:
+  std::size_t rows_;
+  std::size_t cols_;
+  HogwildMode mode_;
+  std::vector<T> data_;
+  StripedLocks locks_;
+};
+
+// A SimpleLinearModel whose copies share one set of weights, for Hogwild
+// training: give each actor thread its own SarsaAgent built from a copy of
+// one model and they all update the same parameters without a global lock.
+// Each copy keeps its own learning rate and result buffer.
+//
+// config keys: those of SimpleLinearModel ("weights", "learning_rate",
+// "simd"), plus "hogwild": "atomic" (default) or "striped".
+template <int tFeaturesDim, int tActionsDim, typename TFeature = double,
+          typename TWeight = DefaultWeight<TFeature>>
+class HogwildLinearModel {
+ public:
+  static constexpr int kFeaturesDim = tFeaturesDim;
+  static constexpr int kActionsDim = tActionsDim;
+  using Feature = TFeature;
+  using Weight = TWeight;
+  using Result = double;
+  using State = std::array<Feature, kFeaturesDim>;
+  using ResultsList = std::array<Result, kActionsDim>;
+
+  HogwildLinearModel(const json &config)
+      : params_(std::make_shared<Parameters>(
+            kActionsDim, kFeaturesDim,
+            NameToHogwildMode(config.value("hogwild", "atomic")),
+            kActionsDim)) {
+    // the weight initialization of the single-threaded model, without the
+    // per-model extras a shared model cannot have
+    json init = config;
+    init.erase("save_grad");
+    init.erase("eligibility_traces");
+    SimpleLinearModel<kFeaturesDim, kActionsDim, Feature, Weight> model(init);
+    std::copy_n(model.ParameterData(), kActionsDim * kFeaturesDim,
+                params_->Data());
+
+    alpha_ = config.value("learning_rate", 1.0);
+    if (config.contains("simd") && config["simd"] != "auto") {
+      simd_ = Kernels::NameToSimdLevel(config["simd"].get<std::string>());
+    }
+  }
+
+  const ResultsList &GetActionValues(const State &state) {
+    const Weight *x = StateData(state);
+    for (int i = 0; i < kActionsDim; ++i) {
+      results_[i] = RowDot(i, x);
+    }
+    return results_;
+  }
+
+  Result GetActionValue(const State &state, int action_idx) {
+    return RowDot(action_idx, StateData(state));
+  }
+
+  void Update(const State &state, int action_idx, double td_target) {
+    const Weight *x = StateData(state);
+    Weight *w = params_->Row(action_idx);
+    if (params_->Mode() == HogwildMode::kStriped) {
+      std::lock_guard<SpinLock> guard(params_->LockFor(action_idx));
+      const double error =
+          td_target - Kernels::Dot(simd_, w, x, kFeaturesDim);
+      Kernels::Axpy(simd_, static_cast<Weight>(alpha_ * error), x, w,
+                    kFeaturesDim);
+      return;
+    }
+    const Weight step =
+        static_cast<Weight>(alpha_ * (td_target - AtomicDot(w, x)));
+    for (int j = 0; j < kFeaturesDim; ++j) {
+      if (x[j] == Weight{}) continue;
+      Parameters::Store(w[j], Parameters::Load(w[j]) + step * x[j]);
+    }
+  }
+
+  void SetLearningRate(double alpha) { alpha_ = alpha; }
+
+  HogwildMode Mode() const { return params_->Mode(); }
+
+  // Number of models sharing these weights.
+  long Sharers() const { return params_.use_count(); }
+
+  void OutputModel(std::string_view fname, char delimiter = '\n',
+                   bool append = false) const {
+    params_->Output(fname, delimiter, append);
+  }
+
+  void LoadModel(std::string_view fname, char delimiter = '\n') {
+    params_->Load(fname, delimiter);
+  }
+
+  // row-major [kActionsDim, kFeaturesDim]
+  const Weight *ParameterData() const { return params_->Data(); }
+
+  void SaveCheckpoint(std::string_view fname) const {
+    params_->SaveCheckpoint(fname);
+  }
+
+  void LoadCheckpoint(std::string_view fname) {
+    params_->LoadCheckpoint(fname);
+  }
+
+ private:
+  using Parameters = HogwildParameters<Weight>;
+
+  static Kernels::SimdLevel AutoSimdLevel() {
+    return kFeaturesDim < 8 ? Kernels::SimdLevel::kScalar
+                            : Kernels::DetectedSimdLevel();
+  }
+
+  const Weight *StateData(const State &state) {
+    if constexpr (std::is_same_v<Feature, Weight>) {
+      return state.data();
+    } else {
+      for (int j = 0; j < kFeaturesDim; ++j) {
+        state_buffer_[j] = static_cast<Weight>(state[j]);
+      }
+      return state_buffer_.data();
+    }
+  }
+
+  // scalar: atomic loads do not vectorize
+  static Weight AtomicDot(Weight *w, const Weight *x) {
+    Weight sum{};
+    for (int j = 0; j < kFeaturesDim; ++j) {
+      sum += Parameters::Load(w[j]) * x[j];
+    }
+    return sum;
+  }
+
+  Result RowDot(int row, const Weight *x) {
+    Weight *w = params_->Row(row);
+    if (params_->Mode() == HogwildMode::kStriped) {
+      std::lock_guard<SpinLock> guard(params_->LockFor(row));
+      return Kernels::Dot(simd_, w, x, kFeaturesDim);
+    }
+    return AtomicDot(w, x);
+  }
+
+  std::shared_ptr<Parameters> params_;
+  ResultsList results_{};
+  std::array<Weight, kFeaturesDim> state_buffer_{};
+  double alpha_{1.0};
+  Kernels::SimdLevel simd_{AutoSimdLevel()};
+};
+
+// A Tabular model whose copies share one table, as HogwildLinearModel. In
+// striped mode the states are spread over "stripes" locks (default 64).
+//
+// config keys: those of Tabular ("action_values", "learning_rate"), plus
+// "hogwild" and "stripes".
+template <int tStatesDim, int tActionsDim>
+class HogwildTabular {
+ public:
+  static constexpr int kActionsDim = tActionsDim;
+  static constexpr int kStatesDim = tStatesDim;
+  using State = int;
+  using Action = int;
+  using Reward = double;
+  using ResultsList = std::array<double, kActionsDim>;
+
+  HogwildTabular(const json &config)
+      : params_(std::make_shared<Parameters>(
+            kStatesDim, kActionsDim,
+            NameToHogwildMode(config.value("hogwild", "atomic")),
+            config.value("stripes", std::size_t{64}))) {
+    json init = config;
+    init.erase("eligibility_traces");
+    // the table can be far too large for the stack
+    auto table = std::make_unique<Tabular<kStatesDim, kActionsDim>>(init);
+    std::copy_n(table->ParameterData(), kStatesDim * kActionsDim,
+                params_->Data());
+    alpha_ = config.value("learning_rate", 1.0);
+  }
+
+  const ResultsList &GetActionValues(State state) {
+    double *q = params_->Row(state);
+    if (params_->Mode() == HogwildMode::kStriped) {
+      std::lock_guard<SpinLock> guard(params_->LockFor(state));
+      std::copy_n(q, kActionsDim, results_.begin());
+      return results_;
+    }
+    for (int a = 0; a < kActionsDim; ++a) {
+      results_[a] = Parameters::Load(q[a]);
+    }
+    return results_;
+  }
+
+  double GetActionValue(State state, int action_idx) {
+    double &q = params_->Row(state)[action_idx];
+    if (params_->Mode() == HogwildMode::kStriped) {
+      std::lock_guard<SpinLock> guard(params_->LockFor(state));
+      return q;
+    }
+    return Parameters::Load(q);
+  }
+
+  void Update(State state, int action_idx, double td_target) {
+    double &q = params_->Row(state)[action_idx];
+    if (params_->Mode() == HogwildMode::kStriped) {
+      std::lock_guard<SpinLock> guard(params_->LockFor(state));
+      q += alpha_ * (td_target - q);
+      return;
+    }
+    const double value = Parameters::Load(q);
+    Parameters::Store(q, value + alpha_ * (td_target - value));
+  }
+
+  void SetLearningRate(double alpha) { alpha_ = alpha; }
+
+  HogwildMode Mode() const { return params_->Mode(); }
+
+  long Sharers() const { return params_.use_count(); }
+
+  void OutputModel(std::string_view fname, char delimiter = '\n',
+                   bool append = false) const {
+    params_->Output(fname, delimiter, append);
+  }
+
+  void LoadModel(std::string_view fname, char delimiter = '\n') {
+    params_->Load(fname, delimiter);
+  }
+
+  // row-major [kStatesDim, kActionsDim]
+  const double *ParameterData() const { return params_->Data(); }
+
+  void SaveCheckpoint(std::string_view fname) const {
+    params_->SaveCheckpoint(fname);
+  }
+
+  void LoadCheckpoint(std::string_view fname) {
+    params_->LoadCheckpoint(fname);
+  }
+
+ private:
+  using Parameters = HogwildParameters<double>;
+
+  std::shared_ptr<Parameters> params_;
+  ResultsList results_{};
+  double alpha_{1.0};
+};
+
+}  // namespace RLlib::Models
+#endif
@@ -1,17 +1,33 @@
 #ifndef MODELS_LINEAR_H
 #define MODELS_LINEAR_H
 #include <agent.h>
+#include <checkpoint.h>
+#include <grad_trace.h>
+#include <kernels.h>
+#include <models/eligibility_traces.h>
 #include <ostream>
 #include <random_generator.h>
 
+#include <algorithm>
 #include <array>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <type_traits>
 
 namespace RLlib::Models {
+// Weights follow floating-point features, so float states train and act in
+// float (twice the SIMD width); integer features get double weights.
+template <typename TFeature>
+using DefaultWeight =
+    std::conditional_t<std::is_floating_point_v<TFeature>, TFeature, double>;
+
 template <int tFeaturesDim, int tActionsDim, typename TFeature = double,
-          typename TWeight = double, typename TResult = double>
+          typename TWeight = DefaultWeight<TFeature>,
+          typename TResult = double>
 class SimpleLinearModel {
  public:
   static constexpr int kFeaturesDim = tFeaturesDim;
@@ -25,6 +41,27 @@ class SimpleLinearModel {
   using ResultsList = std::array<Result, kActionsDim>;
 
   SimpleLinearModel() = default;
+
+  // Copies take everything but the gradient trace ("save_grad"): a copy must
+  // not write into the same file, so it starts untraced.
+  SimpleLinearModel(const SimpleLinearModel &other)
+      : weights_(other.weights_),
+        alpha_(other.alpha_),
+        simd_(other.simd_),
+        fused_forward_(other.fused_forward_),
+        traces_(other.traces_) {}
+  // Keeps this model's own gradient trace, if any.
+  SimpleLinearModel &operator=(const SimpleLinearModel &other) {
+    weights_ = other.weights_;
+    alpha_ = other.alpha_;
+    simd_ = other.simd_;
+    fused_forward_ = other.fused_forward_;
+    traces_ = other.traces_;
+    return *this;
+  }
+  SimpleLinearModel(SimpleLinearModel &&) = default;
+  SimpleLinearModel &operator=(SimpleLinearModel &&) = default;
+
   SimpleLinearModel(const json &config) {
     if (config["weights"].is_array() &&
         config["weights"].size() == kActionsDim) {
@@ -68,70 +105,109 @@ class SimpleLinearModel {
       }
     }
 
-    save_grad_ = static_cast<int>(config.value("save_grad", false));
+    grad_trace_ = GradTrace::FromConfig(config);
+    if (config.contains("simd") && config["simd"] != "auto") {
+      simd_ = Kernels::NameToSimdLevel(config["simd"].get<std::string>());
+    }
+    fused_forward_ = config.value("fused_forward", true);
+    if (config.contains("eligibility_traces")) {
+      traces_.emplace(kActionsDim * kFeaturesDim,
+                      config["eligibility_traces"]);
+    }
   }
 
   const ResultsList &GetActionValues(const State &state) {
+#ifdef DEBUG
     for (int i = 0; i < kActionsDim; ++i) {
-      double value_ = 0.0;
       for (int j = 0; j < kFeaturesDim; ++j) {
-        value_ += weights_[i][j] * state[j];
-#ifdef DEBUG
         std::cout << i << "," << j << "," << weights_[i][j] << std::endl;
+      }
+    }
 #endif
+    const Weight *x = StateData(state);
+    if (fused_forward_) {
+      std::array<Weight, kActionsDim> values;
+      Kernels::MultiDot<kActionsDim>(simd_, weights_[0].data(), kFeaturesDim,
+                                     x, kFeaturesDim, values.data());
+      for (int i = 0; i < kActionsDim; ++i) {
+        results_[i] = values[i];
+      }
+    } else {
+      for (int i = 0; i < kActionsDim; ++i) {
+        results_[i] = Kernels::Dot(simd_, weights_[i].data(), x, kFeaturesDim);
       }
-      results_[i] = value_;
     }
     return results_;
   }
 
+  // Value of a single action: one row of the forward pass.
+  Result GetActionValue(const State &state, int action_idx) {
+    return Kernels::Dot(simd_, weights_[action_idx].data(), StateData(state),
+                        kFeaturesDim);
+  }
+
   void Update(const State &state, int action_idx, double td_target) {
-    // auto last_q = GetActionValues(state)[action_idx];
-    auto last_q = GetActionValues(state)[action_idx];
+    const Weight *x = StateData(state);
+    // only the updated action's row is needed for the TD error
+    Result last_q =
+        Kernels::Dot(simd_, weights_[action_idx].data(), x, kFeaturesDim);
     double error_ = td_target - last_q;
 
 #ifdef DEBUG
     std::cout << "grad " << action_idx << std::endl;
-#endif
     for (int j = 0; j < kFeaturesDim; ++j) {
-
-#ifdef DEBUG
       std::cout << -error_ * state[j] << "\t";
-#endif
-      weights_[action_idx][j] += alpha_ * error_ * state[j];
     }
-
-#ifdef DEBUG
     std::cout << std::endl;
 #endif
+    Kernels::Axpy(simd_, static_cast<Weight>(alpha_ * error_), x,
+                  weights_[action_idx].data(), kFeaturesDim);
     
-    if (save_grad_) {
-      std::ofstream ofs{"grad.txt",
-                        save_grad_ == 1 ? std::ios::out : std::ios::app};
-      if (save_grad_ == 1) {
-        save_grad_ = 2;
-      }
-      ofs << "state = ";
-      for (const auto &s : state) {
-        ofs << s << ",";
+    if (grad_trace_ && grad_trace_->Sample()) {
+      auto record = grad_trace_->Reserve(1, kFeaturesDim,
+                                         kActionsDim * kFeaturesDim);
+      for (int j = 0; j < kFeaturesDim; ++j) {
+        record.states[j] = static_cast<double>(state[j]);
       }
-      ofs << "; action_idx = " << action_idx << "; last_q = " << last_q
-          << "; new_q = " << td_target << "\n";
-      for (int i = 0; i < kActionsDim; ++i) {
-        Weight action_error = 0.0;
-        if (i == action_idx) {
-          action_error = error_;
-        }
-        for (int j = 0; j < kFeaturesDim; ++j) {
-          ofs << -action_error * state[j];
-          if (j < kFeaturesDim - 1) ofs << "\t";
-        }
-        ofs << '\n';
+      record.actions[0] = action_idx;
+      record.last_q[0] = last_q;
+      record.new_q[0] = td_target;
+      // d(0.5 * error^2)/dw is non-zero only in the updated action's row
+      std::fill(record.grad.begin(), record.grad.end(), 0.0);
+      for (int j = 0; j < kFeaturesDim; ++j) {
+        record.grad[action_idx * kFeaturesDim + j] =
+            -error_ * static_cast<double>(state[j]);
       }
-      ofs << '\n';
     }
   }
 
+  bool HasTraces() const { return traces_.has_value(); }
+
+  // Backward-view TD(lambda): the trace of the updated action's row grows by
+  // the state features (the gradient of Q), every live weight moves by
+  // alpha * error * trace, then the traces decay by gamma * lambda.
+  void TraceUpdate(const State &state, int action_idx, double td_target,
+                   double gamma) {
+    const Weight *x = StateData(state);
+    const double error =
+        td_target -
+        Kernels::Dot(simd_, weights_[action_idx].data(), x, kFeaturesDim);
+    const std::size_t row = static_cast<std::size_t>(action_idx) * kFeaturesDim;
+    for (int j = 0; j < kFeaturesDim; ++j) {
+      if (x[j] != Weight{}) traces_->Visit(row + j, static_cast<double>(x[j]));
+    }
+    Weight *w = weights_[0].data();
+    const double step = alpha_ * error;
+    traces_->Apply(gamma * traces_->Lambda(),
+                   [w, step](std::size_t i, double trace) {
+                     w[i] += static_cast<Weight>(step * trace);
+                   });
+  }
+
+  void ClearTraces() {
+    if (traces_) traces_->Clear();
+  }
+
   void SetLearningRate(double alpha) { alpha_ = alpha; }
 
   void OutputModel(std::string_view fname, char delimiter = '\n',
@@ -172,11 +248,44 @@ class SimpleLinearModel {
     }
   }
 
+  // row-major [kActionsDim, kFeaturesDim]
+  const Weight *ParameterData() const { return weights_[0].data(); }
+
+  void SaveCheckpoint(std::string_view fname) const {
+    Checkpoint::Save(fname, kActionsDim, kFeaturesDim, weights_[0].data());
+  }
+
+  void LoadCheckpoint(std::string_view fname) {
+    Checkpoint::Load(fname, kActionsDim, kFeaturesDim, weights_[0].data());
+  }
+
  private:
+  // below a couple of vector widths the call overhead outweighs SIMD
+  static Kernels::SimdLevel AutoSimdLevel() {
+    return kFeaturesDim < 8 ? Kernels::SimdLevel::kScalar
+                            : Kernels::DetectedSimdLevel();
+  }
+
+  // the kernels need the state in the weight type; convert only if it is not
+  const Weight *StateData(const State &state) {
+    if constexpr (std::is_same_v<Feature, Weight>) {
+      return state.data();
+    } else {
+      for (int j = 0; j < kFeaturesDim; ++j) {
+        state_buffer_[j] = static_cast<Weight>(state[j]);
+      }
+      return state_buffer_.data();
+    }
+  }
+
   WeightsList weights_{};
   ResultsList results_{};
+  Weights state_buffer_{};
   double alpha_{1.0};
-  int save_grad_{};
+  std::unique_ptr<GradTrace> grad_trace_{};
+  Kernels::SimdLevel simd_{AutoSimdLevel()};
+  bool fused_forward_{true};
+  std::optional<EligibilityTraces> traces_{};
 };
 }  // namespace RLlib::Models
 #endif
\ No newline at end of file
@@ -1,19 +1,100 @@
 #ifndef RL_OFFPOLICY_REPLAY_H
 #define RL_OFFPOLICY_REPLAY_H
 
+#include <concurrency.h>
+#include <grad_trace.h>
+#include <models/replay_buffer.h>
+#include <models/replay_sampler.h>
 #include <models/torch/linear.h>
 #include <torch/torch.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <random>
 #include <stdexcept>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 #include "agent.h"
 
 namespace RLlib::Models {
 
+enum class TargetUpdateMode {
+  kNone = 0,
+  kHard = 1,
+  kPolyak = 2,
+  kModesCount = 3
+};
+
+constexpr const char *TargetUpdateModeNames[] = {"none", "hard", "polyak"};
+
+inline TargetUpdateMode NameToTargetUpdateMode(std::string_view name) {
+  for (int i = 0; i < static_cast<int>(TargetUpdateMode::kModesCount); ++i) {
+    if (name == TargetUpdateModeNames[i]) {
+      return static_cast<TargetUpdateMode>(i);
+    }
+  }
+  throw std::runtime_error("Invalid TargetUpdateMode name");
+}
+
+// Where the TD targets of replayed samples come from: computed by the agent
+// when the transition is stored, or recomputed at train time from the raw
+// transition with the current target (DQN) or online-argmax / target-value
+// (Double DQN) networks.
+enum class ReplayTargetMode {
+  kPrecomputed = 0,
+  kDQN = 1,
+  kDoubleDQN = 2,
+  kModesCount = 3
+};
+
+constexpr const char *ReplayTargetModeNames[] = {"precomputed", "dqn",
+                                                 "double_dqn"};
+
+inline ReplayTargetMode NameToReplayTargetMode(std::string_view name) {
+  for (int i = 0; i < static_cast<int>(ReplayTargetMode::kModesCount); ++i) {
+    if (name == ReplayTargetModeNames[i]) {
+      return static_cast<ReplayTargetMode>(i);
+    }
+  }
+  throw std::runtime_error("Invalid ReplayTargetMode name");
+}
+
+// Learns a Q-network from a replay buffer. By default every Update() trains
+// one minibatch on the calling thread. With "async_learner": true, Update()
+// only pushes the transition into a lock-free queue; a dedicated learner
+// thread drains it into the replay buffer and trains on it, publishing a
+// copy of the parameters every publish_interval minibatches. The acting
+// side (GetActionValues) reads the latest published copy through a triple
+// buffer, so neither thread blocks on the other.
+//
+// The learner trains at most updates_per_transition minibatches per
+// transition it receives (default 1, the same ratio as the synchronous
+// mode; fractions accumulate), and idles once that budget is spent, so the
+// update-to-data ratio does not depend on how fast the machine is. 0 lifts
+// the cap: the learner then trains nonstop on whatever the buffer holds.
+//
+// An optional target network ("target_network": {"mode": "hard" |
+// "polyak", "sync_interval", "tau"}) supplies the bootstrap values returned
+// by GetTargetActionValues(). It belongs to the acting thread and trails the
+// acting parameters: a full copy every sync_interval Update() calls, or
+// target <- target + tau * (online - target) after every call.
+//
+// With "replay_targets": "dqn" or "double_dqn" the replay holds raw
+// transitions (s, a, r, s', done, discount) pushed through
+// UpdateTransition(), and each minibatch recomputes
+// y = r + discount * (1 - done) * V(s') in one batched forward, so stale
+// targets never enter the loss. Since the learner does the bootstrapping, in
+// async mode it also owns the target network and steps it once per
+// minibatch.
+//
+// The network's Feature type sets the training precision: a float network
+// trains on float states with the loss computed in float, while rewards,
+// discounts and targets stay double. "bf16_replay_states": true stores the
+// replayed states as bfloat16.
 template <typename Net>
 class OffPolicyReplayLearner {
  public:
@@ -24,10 +105,17 @@ class OffPolicyReplayLearner {
   static constexpr int kFeaturesDim = Net::kFeaturesDim;
   static constexpr int kActionsDim = Net::kActionsDim;
 
+  using ReplayBuffer =
+      ColumnarReplayBuffer<kFeaturesDim, typename Net::Feature>;
+
   struct Transition {
     State state;
     int action;
     double td_target;
+    double reward{};
+    State next_state{};
+    double discount{};
+    bool done{};
   };
 
   explicit OffPolicyReplayLearner(const json &config)
@@ -36,20 +124,32 @@ class OffPolicyReplayLearner {
         replay_capacity_(
             config.value("replay_capacity", static_cast<std::size_t>(100000))),
         batch_size_(config.value("batch_size", static_cast<std::size_t>(32))),
-        rng_(std::random_device{}()),
-        save_grad_{static_cast<int>(config.value("save_grad", false))} {
+        rng_(rng_util::new_stream()),
+        replay_targets_(NameToReplayTargetMode(
+            config.value("replay_targets", "precomputed"))),
+        replay_buffer_(replay_capacity_, batch_size_,
+                       config.value("pin_memory", false),
+                       replay_targets_ != ReplayTargetMode::kPrecomputed,
+                       config.value("bf16_replay_states", false)),
+        sampler_(config.value("sample_with_replacement", false), batch_size_),
+        grad_trace_(GradTrace::FromConfig(config)),
+        async_(config.value("async_learner", false)),
+        publish_interval_(config.value("publish_interval",
+                                       static_cast<std::size_t>(100))),
+        updates_per_transition_(config.value("updates_per_transition", 1.0)) {
     if (batch_size_ == 0) {
       throw std::runtime_error("batch_size must be > 0");
     }
     if (batch_size_ > replay_capacity_) {
       throw std::runtime_error("batch_size must be <= replay_capacity");
     }
-    replay_buffer_.reserve(replay_capacity_);
-
-    batch_states_.reserve(batch_size_);
-    batch_actions_.reserve(batch_size_);
-    batch_targets_.reserve(batch_size_);
-    reshuffle_indices_.reserve(replay_capacity_);
+    if (config.contains("prioritized_replay")) {
+      prioritized_ = std::make_unique<PrioritizedSampler>(
+          replay_capacity_, config["prioritized_replay"], batch_size_);
+      batch_weights_ = torch::empty(
+          {static_cast<int64_t>(batch_size_)},
+          torch::TensorOptions().dtype(torch::kFloat64).device(torch::kCPU));
+    }
 
     auto optimizer_config =
         config.value("optimizer", json::object({{"type", "adam"}}));
@@ -64,188 +164,418 @@ class OffPolicyReplayLearner {
       throw std::runtime_error("Unknown optimizer type: " + optimizer_type +
                                " (supported: adam, sgd)");
     }
+
+    if (config.contains("target_network")) {
+      const auto &target_config = config["target_network"];
+      target_mode_ =
+          NameToTargetUpdateMode(target_config.value("mode", "hard"));
+      target_sync_interval_ = target_config.value(
+          "sync_interval", static_cast<std::size_t>(1000));
+      target_tau_ = target_config.value("tau", 0.005);
+      if (target_mode_ == TargetUpdateMode::kHard &&
+          target_sync_interval_ == 0) {
+        throw std::runtime_error("target_network sync_interval must be > 0");
+      }
+      if (target_mode_ == TargetUpdateMode::kPolyak &&
+          !(target_tau_ > 0.0 && target_tau_ <= 1.0)) {
+        throw std::runtime_error("target_network tau must be in (0, 1]");
+      }
+      if (target_mode_ != TargetUpdateMode::kNone) {
+        target_ = std::make_unique<Network>(config);
+        CopyParameters(net_, *target_);
+      }
+    }
+
+    if (async_) {
+      if (publish_interval_ == 0) {
+        throw std::runtime_error("publish_interval must be > 0");
+      }
+      if (!(updates_per_transition_ >= 0.0)) {
+        throw std::runtime_error("updates_per_transition must be >= 0");
+      }
+      transitions_ = std::make_unique<SpscQueue<Transition>>(config.value(
+          "transition_queue_capacity", static_cast<std::size_t>(65536)));
+      for (auto &snapshot : snapshots_) {
+        snapshot = std::make_unique<Network>(config);
+        CopyParameters(net_, *snapshot);
+      }
+      StartLearner();
+    }
   }
 
+  ~OffPolicyReplayLearner() { StopLearner(); }
+
   const ResultsList &GetActionValues(const State &state) {
-    return net_.GetActionValues(state);
+    return ActingNet().GetActionValues(state);
+  }
+
+  const std::vector<ResultsList> &GetBatchActionValues(
+      const std::vector<State> &states) {
+    return ActingNet().GetBatchActionValues(states);
+  }
+
+  bool HasTargetNetwork() const { return target_ != nullptr; }
+
+  // True when targets are recomputed from raw transitions; the agent then
+  // calls UpdateTransition() instead of Update().
+  bool RecomputesTargets() const {
+    return replay_targets_ != ReplayTargetMode::kPrecomputed;
+  }
+
+  // Bootstrap values from the target network (the acting network if none).
+  const ResultsList &GetTargetActionValues(const State &state) {
+    if (!target_ || LearnerOwnsTarget()) return GetActionValues(state);
+    return target_->GetActionValues(state);
   }
 
   void Update(const State &state, int action_idx, double td_target) {
-    PushTransition(state, action_idx, td_target);
-    if (replay_buffer_.size() >= batch_size_) {
+    if (RecomputesTargets()) {
+      throw std::runtime_error(
+          "Update requires replay_targets precomputed, use UpdateTransition");
+    }
+    if (async_) {
+      // backpressure: wait for the learner rather than drop transitions
+      while (!transitions_->TryPush(Transition{state, action_idx, td_target})) {
+        std::this_thread::yield();
+      }
+    } else {
+      StoreTransition(Transition{state, action_idx, td_target});
+      if (replay_buffer_.Size() >= batch_size_) {
+        TrainFromReplay();
+      }
+    }
+    if (target_) UpdateTarget(ActingNet());
+  }
+
+  // Stores the raw transition; discount is the product of the per-step
+  // discounts between state and next_state (gamma^n for n-step returns).
+  void UpdateTransition(const State &state, int action_idx, double reward,
+                        const State &next_state, double discount,
+                        bool done = false) {
+    if (!RecomputesTargets()) {
+      throw std::runtime_error(
+          "UpdateTransition requires replay_targets dqn or double_dqn");
+    }
+    Transition tr{state, action_idx, 0.0, reward, next_state, discount, done};
+    if (async_) {
+      while (!transitions_->TryPush(tr)) {
+        std::this_thread::yield();
+      }
+      return;
+    }
+    StoreTransition(tr);
+    if (replay_buffer_.Size() >= batch_size_) {
       TrainFromReplay();
     }
+    if (target_) UpdateTarget(net_);
   }
 
   void SetLearningRate(double alpha) {
-    alpha_ = alpha;
-    for (auto &group : optimizer_->param_groups()) {
-      auto &opts = group.options();
-      if (auto *adam_opts = dynamic_cast<torch::optim::AdamOptions *>(&opts)) {
-        adam_opts->lr(alpha_);
-      } else if (auto *sgd_opts =
-                     dynamic_cast<torch::optim::SGDOptions *>(&opts)) {
-        sgd_opts->lr(alpha_);
-      }
+    if (async_) {
+      // applied by the learner thread before its next minibatch
+      pending_alpha_.store(alpha, std::memory_order_relaxed);
+      alpha_dirty_.store(true, std::memory_order_release);
+      return;
     }
+    ApplyLearningRate(alpha);
   }
 
+  // In async mode this writes the parameters last published to the actor.
   void OutputModel(std::string_view fname, char delimiter = '\n',
                    bool append = false) const {
+    if (async_) {
+      snapshots_[snapshot_index_.Front()]->OutputModel(fname, delimiter,
+                                                       append);
+      return;
+    }
     net_.OutputModel(fname, delimiter, append);
   }
 
   void LoadModel(std::string_view fname, char delimiter = '\n') {
+    StopLearner();
     net_.LoadModel(fname, delimiter);
+    if (target_) CopyParameters(net_, *target_);
+    if (async_) {
+      for (auto &snapshot : snapshots_) {
+        CopyParameters(net_, *snapshot);
+      }
+      StartLearner();
+    }
   }
 
+  void SaveCheckpoint(std::string_view fname) const {
+    if (async_) {
+      snapshots_[snapshot_index_.Front()]->SaveCheckpoint(fname);
+      return;
+    }
+    net_.SaveCheckpoint(fname);
+  }
+
+  void LoadCheckpoint(std::string_view fname) {
+    StopLearner();
+    net_.LoadCheckpoint(fname);
+    if (target_) CopyParameters(net_, *target_);
+    if (async_) {
+      for (auto &snapshot : snapshots_) {
+        CopyParameters(net_, *snapshot);
+      }
+      StartLearner();
+    }
+  }
+
+  // The acting network's parameters: in async mode the copy last published
+  // to the actor.
+  const auto *ParameterData() { return ActingNet().ParameterData(); }
+
+  // The trained network; in async mode it is owned by the learner thread.
   Network &GetNet() { return net_; }
   const Network &GetNet() const { return net_; }
 
  private:
-  void PushTransition(const State &state, int action, double td_target) {
-    if (replay_buffer_.size() < replay_capacity_) {
-      replay_buffer_.push_back(Transition{state, action, td_target});
-    } else {
-      replay_buffer_[replay_pos_] = Transition{state, action, td_target};
+  Network &ActingNet() {
+    if (async_) {
+      snapshot_index_.Acquire();
+      return *snapshots_[snapshot_index_.Front()];
     }
-    replay_pos_ = (replay_pos_ + 1) % replay_capacity_;
+    return net_;
   }
 
-  void TrainFromReplay() {
-    const std::size_t buffer_size = replay_buffer_.size();
-    if (buffer_size < batch_size_) return;
+  bool LearnerOwnsTarget() const { return async_ && RecomputesTargets(); }
 
-    reshuffle_indices_.resize(buffer_size);
-    std::iota(reshuffle_indices_.begin(), reshuffle_indices_.end(), 0);
-    std::shuffle(reshuffle_indices_.begin(), reshuffle_indices_.end(), rng_);
+  void StoreTransition(const Transition &tr) {
+    const std::size_t slot =
+        RecomputesTargets()
+            ? replay_buffer_.Push(tr.state, tr.action, tr.reward,
+                                  tr.next_state, tr.discount, tr.done)
+            : replay_buffer_.Push(tr.state, tr.action, tr.td_target);
+    if (prioritized_) {
+      prioritized_->Add(slot);
+    }
+  }
 
-    batch_states_.clear();
-    batch_actions_.clear();
-    batch_targets_.clear();
+  static void CopyParameters(Network &from, Network &to) {
+    torch::NoGradGuard no_grad;
+    auto src = from.parameters();
+    auto dst = to.parameters();
+    for (std::size_t i = 0; i < src.size(); ++i) {
+      dst[i].copy_(src[i]);
+    }
+    // e.g. JITNetwork's frozen inference copy
+    if constexpr (requires { to.RefreshInference(); }) {
+      to.RefreshInference();
+    }
+  }
 
-    for (std::size_t i = 0; i < batch_size_; ++i) {
-      const auto &tr = replay_buffer_[reshuffle_indices_[i]];
-      batch_states_.push_back(tr.state);
-      batch_actions_.push_back(tr.action);
-      batch_targets_.push_back(tr.td_target);
+  void UpdateTarget(Network &online_net) {
+    if (target_mode_ == TargetUpdateMode::kHard) {
+      if (++updates_since_target_sync_ >= target_sync_interval_) {
+        CopyParameters(online_net, *target_);
+        updates_since_target_sync_ = 0;
+      }
+      return;
     }
+    // one multi-tensor lerp over all parameters, in place
+    torch::NoGradGuard no_grad;
+    auto online = online_net.parameters();
+    auto target = target_->parameters();
+    torch::_foreach_lerp_(target, online, target_tau_);
+  }
 
-    UpdateMinibatch(batch_states_, batch_actions_, batch_targets_);
+  void StartLearner() {
+    stop_.store(false, std::memory_order_release);
+    learner_ = std::thread([this]() { LearnerLoop(); });
   }
 
-  void UpdateMinibatch(const std::vector<State> &states,
-                       const std::vector<int> &actions,
-                       const std::vector<double> &td_targets) {
-    const std::size_t B = states.size();
-    if (B == 0) return;
-    if (actions.size() != B || td_targets.size() != B) {
-      throw std::runtime_error("Minibatch vectors must have the same size");
-    }
+  void StopLearner() {
+    if (!learner_.joinable()) return;
+    stop_.store(true, std::memory_order_release);
+    learner_.join();
+  }
 
-    const auto optsD =
-        torch::TensorOptions().dtype(torch::kFloat64).device(torch::kCPU);
-    const auto optsL =
-        torch::TensorOptions().dtype(torch::kLong).device(torch::kCPU);
-
-    torch::Tensor X = torch::empty({static_cast<long>(B), kFeaturesDim}, optsD);
-    {
-      auto X_acc = X.accessor<double, 2>();
-      for (std::size_t b = 0; b < B; ++b) {
-        for (int j = 0; j < kFeaturesDim; ++j) {
-          X_acc[b][j] = static_cast<double>(states[b][j]);
+  void LearnerLoop() {
+    Transition tr;
+    std::size_t updates_since_publish = 0;
+    // minibatches the received transitions still pay for
+    double budget = 0.0;
+    const bool capped = updates_per_transition_ > 0.0;
+    while (!stop_.load(std::memory_order_acquire)) {
+      bool received = false;
+      for (std::size_t i = 0;
+           i < transitions_->Capacity() && transitions_->TryPop(tr); ++i) {
+        StoreTransition(tr);
+        received = true;
+        // like the synchronous mode, nothing trains before a full batch
+        if (replay_buffer_.Size() >= batch_size_) {
+          budget += updates_per_transition_;
         }
       }
+      if (replay_buffer_.Size() < batch_size_ || (capped && budget < 1.0)) {
+        if (!received) std::this_thread::yield();
+        continue;
+      }
+      if (capped) budget -= 1.0;
+      if (alpha_dirty_.exchange(false, std::memory_order_acquire)) {
+        ApplyLearningRate(pending_alpha_.load(std::memory_order_relaxed));
+      }
+      TrainFromReplay();
+      if (target_ && LearnerOwnsTarget()) UpdateTarget(net_);
+      if (++updates_since_publish >= publish_interval_) {
+        CopyParameters(net_, *snapshots_[snapshot_index_.Back()]);
+        snapshot_index_.Publish();
+        updates_since_publish = 0;
+      }
     }
+  }
 
-    torch::Tensor A = torch::empty({static_cast<int64_t>(B)}, optsL);
-    {
-      auto A_acc = A.accessor<int64_t, 1>();
-      for (std::size_t b = 0; b < B; ++b) {
-        A_acc[b] = static_cast<int64_t>(actions[b]);
+  void ApplyLearningRate(double alpha) {
+    alpha_ = alpha;
+    for (auto &group : optimizer_->param_groups()) {
+      auto &opts = group.options();
+      if (auto *adam_opts = dynamic_cast<torch::optim::AdamOptions *>(&opts)) {
+        adam_opts->lr(alpha_);
+      } else if (auto *sgd_opts =
+                     dynamic_cast<torch::optim::SGDOptions *>(&opts)) {
+        sgd_opts->lr(alpha_);
       }
     }
+  }
 
-    torch::Tensor Y = torch::empty({static_cast<long>(B)}, optsD);
-    {
-      auto Y_acc = Y.accessor<double, 1>();
-      for (std::size_t b = 0; b < B; ++b) {
-        Y_acc[b] = td_targets[b];
-      }
+  void TrainFromReplay() {
+    const std::size_t buffer_size = replay_buffer_.Size();
+    if (buffer_size < batch_size_) return;
+
+    if (!prioritized_) {
+      replay_buffer_.Gather(sampler_.Sample(buffer_size, batch_size_, rng_));
+      UpdateMinibatch(replay_buffer_.BatchStates(),
+                      replay_buffer_.BatchActions(), BatchTargets());
+      return;
+    }
+
+    const auto &indices = prioritized_->Sample(batch_size_, rng_);
+    replay_buffer_.Gather(indices);
+    std::copy(prioritized_->Weights().begin(), prioritized_->Weights().end(),
+              batch_weights_.template data_ptr<double>());
+    const auto td_errors = UpdateMinibatch(
+        replay_buffer_.BatchStates(), replay_buffer_.BatchActions(),
+        BatchTargets(), batch_weights_);
+    const auto td_errors_cpu = td_errors.to(torch::kFloat64).contiguous();
+    prioritized_->UpdatePriorities(indices,
+                                   td_errors_cpu.template data_ptr<double>());
+  }
+
+  // Targets of the gathered minibatch; recomputed from the raw transitions
+  // unless the agent supplied them.
+  torch::Tensor BatchTargets() {
+    if (!RecomputesTargets()) return replay_buffer_.BatchTargets();
+    torch::NoGradGuard no_grad;
+    const auto &S2 = replay_buffer_.BatchNextStates();
+    Network &bootstrap = target_ ? *target_ : net_;
+    const auto Q_next = bootstrap.forward(S2);
+    torch::Tensor next_values;
+    if (replay_targets_ == ReplayTargetMode::kDoubleDQN) {
+      // select with the online network, evaluate with the target network
+      const auto best = net_.forward(S2).argmax(1, /*keepdim=*/true);
+      next_values = Q_next.gather(1, best).squeeze(1);
+    } else {
+      next_values = Q_next.amax(1);
+    }
+    const auto discounts = replay_buffer_.BatchDiscounts().masked_fill(
+        replay_buffer_.BatchDones(), 0.0);
+    return torch::addcmul(replay_buffer_.BatchRewards(), discounts,
+                          next_values.to(torch::kFloat64));
+  }
+
+  // Returns the detached TD errors Q(s, a) - y of the minibatch. W holds
+  // optional per-sample importance-sampling weights for the loss.
+  torch::Tensor UpdateMinibatch(const torch::Tensor &X, const torch::Tensor &A,
+                                const torch::Tensor &Y,
+                                const torch::Tensor &W = {}) {
+    if (X.size(0) == 0) return {};
+    if (A.size(0) != X.size(0) || Y.size(0) != X.size(0)) {
+      throw std::runtime_error("Minibatch tensors must have the same size");
     }
 
     const auto Q = net_.forward(X);
     const auto A2 = A.unsqueeze(1);
     const auto Q_a = Q.gather(1, A2).squeeze(1);
 
-    const auto diff = Q_a - Y;
-    const auto loss = 0.5 * torch::mean(diff * diff);
+    // targets and weights are kept in double; the loss runs in the
+    // network's precision
+    const auto dtype = Q_a.scalar_type();
+    const auto diff = Q_a - Y.to(dtype);
+    const auto loss = W.defined() ? 0.5 * torch::mean(W.to(dtype) * diff * diff)
+                                  : 0.5 * torch::mean(diff * diff);
 
     optimizer_->zero_grad();
     loss.backward();
-    if (save_grad_) {
-      std::ofstream grad_file{"grad.txt",
-                              save_grad_ == 1 ? std::ios::out : std::ios::app};
-      if (save_grad_ == 1) {
-        save_grad_ = 2;
-      }
-
-      if (!grad_file.is_open())
-        throw std::runtime_error("Failed to open grad.txt");
-
-      grad_file << "state = ";
-      for (const auto &s : states) {
-        for (const auto &is : s) grad_file << is << ",";
-        grad_file << "|";
-      }
-      grad_file << "; action_idx = ";
-      for (const auto &a : actions) {
-        grad_file << a << ",";
-      }
-      auto Q_a_cpu = Q_a.detach().to(torch::kCPU);
-      auto Q_a_acc = Q_a_cpu.template accessor<double, 1>();
-
-      grad_file << "; last_q = ";
-      for (int64_t i = 0; i < Q_a_cpu.size(0); ++i) {
-        grad_file << Q_a_acc[i] << ",";
-      }
-      grad_file << "; new_q = ";
-      for (const auto &a : td_targets) {
-        grad_file << a << ",";
-      }
-      grad_file << "\n";
-
-#ifdef DEBUG
-      std::cout << "grad:" << std::endl;
-#endif
-      for (const auto &param : net_.parameters()) {
-        if (!param.grad().defined()) continue;
-
-        auto g = param.grad().detach().to(torch::kCPU);
-        grad_file << g << "\n";
-
-#ifdef DEBUG
-        std::cout << g << std::endl;
-#endif
-      }
+    if (grad_trace_ && grad_trace_->Sample()) {
+      TraceGradients(X, A, Q_a, Y);
     }
     optimizer_->step();
+    return diff.detach();
+  }
+
+  void TraceGradients(const torch::Tensor &X, const torch::Tensor &A,
+                      const torch::Tensor &Q_a, const torch::Tensor &Y) {
+    std::vector<torch::Tensor> grads;
+    int64_t grad_elems = 0;
+    for (const auto &param : net_.parameters()) {
+      if (!param.grad().defined()) continue;
+      grads.push_back(param.grad().detach().to(torch::kCPU, torch::kFloat64)
+                          .contiguous());
+      grad_elems += grads.back().numel();
+    }
+    const auto B = X.size(0);
+    auto record = grad_trace_->Reserve(static_cast<std::uint32_t>(B),
+                                       kFeaturesDim,
+                                       static_cast<std::uint32_t>(grad_elems));
+    auto copy = [](const torch::Tensor &t, std::span<double> out) {
+      const auto src = t.detach().to(torch::kCPU, torch::kFloat64).contiguous();
+      std::memcpy(out.data(), src.template data_ptr<double>(),
+                  out.size() * sizeof(double));
+    };
+    copy(X, record.states);
+    copy(A, record.actions);
+    copy(Q_a, record.last_q);
+    copy(Y, record.new_q);
+    double *out = record.grad.data();
+    for (const auto &g : grads) {
+      std::memcpy(out, g.template data_ptr<double>(),
+                  g.numel() * sizeof(double));
+      out += g.numel();
+    }
   }
 
   Network net_;
   double alpha_;
   std::unique_ptr<torch::optim::Optimizer> optimizer_;
 
-  std::vector<Transition> replay_buffer_;
   std::size_t replay_capacity_;
   std::size_t batch_size_;
-  std::size_t replay_pos_{0};
-  std::minstd_rand rng_;
-  std::vector<State> batch_states_;
-  std::vector<int> batch_actions_;
-  std::vector<double> batch_targets_;
-  std::vector<size_t> reshuffle_indices_;
-  int save_grad_{};
+  rng_util::Xoshiro256PlusPlus rng_;
+  ReplayTargetMode replay_targets_;
+  ReplayBuffer replay_buffer_;
+  MinibatchSampler sampler_;
+  std::unique_ptr<PrioritizedSampler> prioritized_{};
+  torch::Tensor batch_weights_;
+  std::unique_ptr<GradTrace> grad_trace_{};
+
+  bool async_;
+  std::size_t publish_interval_;
+  double updates_per_transition_;
+  std::unique_ptr<SpscQueue<Transition>> transitions_{};
+  std::array<std::unique_ptr<Network>, 3> snapshots_{};
+  TripleBufferIndex snapshot_index_{};
+  std::atomic<double> pending_alpha_{0.0};
+  std::atomic<bool> alpha_dirty_{false};
+  std::atomic<bool> stop_{false};
+  std::thread learner_{};
+
+  TargetUpdateMode target_mode_{TargetUpdateMode::kNone};
+  std::size_t target_sync_interval_{1000};
+  double target_tau_{0.005};
+  std::size_t updates_since_target_sync_{0};
+  std::unique_ptr<Network> target_{};
 };
 
 template <int tFeaturesDim, int tActionsDim, typename TFeature>
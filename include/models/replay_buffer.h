@@ -0,0 +1,208 @@
+#ifndef MODELS_REPLAY_BUFFER_H
+#define MODELS_REPLAY_BUFFER_H
+
+#include <torch/torch.h>
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace RLlib::Models {
+
+// Replay storage laid out column by column: one contiguous
+// [capacity, kFeaturesDim] state matrix plus action and target columns, all
+// owned by torch tensors. Minibatches are assembled with one index_select per
+// column into batch tensors that are allocated once and reused.
+//
+// With store_transitions the buffer keeps raw transitions instead of
+// precomputed targets: reward, next-state matrix, discount and done columns,
+// from which the learner recomputes targets at train time.
+//
+// With bf16_states the state and next-state matrices are stored as bfloat16
+// (a half or a quarter of the float / double footprint, rounded to 8
+// mantissa bits) and widened back to Feature when a minibatch is gathered;
+// the batch tensors the learner sees keep the Feature dtype.
+template <int tFeaturesDim, typename TFeature = double>
+class ColumnarReplayBuffer {
+ public:
+  static constexpr int kFeaturesDim = tFeaturesDim;
+  using Feature = TFeature;
+  using State = std::array<Feature, kFeaturesDim>;
+
+  ColumnarReplayBuffer(std::size_t capacity, std::size_t batch_size,
+                       bool pin_memory = false, bool store_transitions = false,
+                       bool bf16_states = false)
+      : capacity_(capacity),
+        store_transitions_(store_transitions),
+        bf16_states_(bf16_states) {
+    if (capacity_ == 0) {
+      throw std::runtime_error("replay_capacity must be > 0");
+    }
+    if constexpr (!std::is_floating_point_v<Feature>) {
+      if (bf16_states_) {
+        throw std::runtime_error("bf16 replay states need float features");
+      }
+    }
+    const auto optsF = torch::TensorOptions()
+                           .dtype(torch::CppTypeToScalarType<Feature>::value)
+                           .device(torch::kCPU);
+    const auto optsD =
+        torch::TensorOptions().dtype(torch::kFloat64).device(torch::kCPU);
+    const auto optsL =
+        torch::TensorOptions().dtype(torch::kLong).device(torch::kCPU);
+    const auto optsS =
+        bf16_states_ ? optsF.dtype(torch::kBFloat16) : optsF;
+    const auto N = static_cast<int64_t>(capacity_);
+    const auto B = static_cast<int64_t>(batch_size);
+
+    states_ = torch::empty({N, kFeaturesDim}, optsS);
+    actions_ = torch::empty({N}, optsL);
+    targets_ = torch::empty({N}, optsD);
+
+    // pinned host memory only exists with a CUDA runtime
+    const bool pin = pin_memory && torch::cuda::is_available();
+    batch_states_ = torch::empty({B, kFeaturesDim}, optsF.pinned_memory(pin));
+    batch_actions_ = torch::empty({B}, optsL.pinned_memory(pin));
+    batch_targets_ = torch::empty({B}, optsD.pinned_memory(pin));
+    batch_index_ = torch::empty({B}, optsL);
+    if (bf16_states_) {
+      gathered_states_ = torch::empty({B, kFeaturesDim}, optsS);
+    }
+
+    if (store_transitions_) {
+      const auto optsB =
+          torch::TensorOptions().dtype(torch::kBool).device(torch::kCPU);
+      rewards_ = torch::empty({N}, optsD);
+      next_states_ = torch::empty({N, kFeaturesDim}, optsS);
+      discounts_ = torch::empty({N}, optsD);
+      dones_ = torch::empty({N}, optsB);
+      batch_rewards_ = torch::empty({B}, optsD.pinned_memory(pin));
+      batch_next_states_ =
+          torch::empty({B, kFeaturesDim}, optsF.pinned_memory(pin));
+      batch_discounts_ = torch::empty({B}, optsD.pinned_memory(pin));
+      batch_dones_ = torch::empty({B}, optsB.pinned_memory(pin));
+    }
+  }
+
+  // Returns the slot that was written.
+  std::size_t Push(const State &state, int action, double td_target) {
+    const std::size_t slot = pos_;
+    WriteState(states_, state);
+    actions_.template data_ptr<int64_t>()[pos_] = action;
+    targets_.template data_ptr<double>()[pos_] = td_target;
+    pos_ = (pos_ + 1) % capacity_;
+    if (size_ < capacity_) ++size_;
+    return slot;
+  }
+
+  // Raw transition; requires store_transitions. Returns the slot written.
+  std::size_t Push(const State &state, int action, double reward,
+                   const State &next_state, double discount, bool done) {
+    if (!store_transitions_) {
+      throw std::runtime_error("Replay buffer does not store transitions");
+    }
+    WriteState(next_states_, next_state);
+    rewards_.template data_ptr<double>()[pos_] = reward;
+    discounts_.template data_ptr<double>()[pos_] = discount;
+    dones_.template data_ptr<bool>()[pos_] = done;
+    return Push(state, action, 0.0);
+  }
+
+  // Fills the batch tensors with the given rows.
+  void Gather(const std::vector<std::size_t> &indices) {
+    const auto B = static_cast<int64_t>(indices.size());
+    if (batch_index_.size(0) != B) {
+      batch_index_.resize_({B});
+    }
+    auto *idx = batch_index_.template data_ptr<int64_t>();
+    for (int64_t b = 0; b < B; ++b) {
+      idx[b] = static_cast<int64_t>(indices[b]);
+    }
+    GatherStates(batch_states_, states_);
+    torch::index_select_out(batch_actions_, actions_, 0, batch_index_);
+    if (store_transitions_) {
+      torch::index_select_out(batch_rewards_, rewards_, 0, batch_index_);
+      GatherStates(batch_next_states_, next_states_);
+      torch::index_select_out(batch_discounts_, discounts_, 0, batch_index_);
+      torch::index_select_out(batch_dones_, dones_, 0, batch_index_);
+    } else {
+      torch::index_select_out(batch_targets_, targets_, 0, batch_index_);
+    }
+  }
+
+  const torch::Tensor &BatchStates() const { return batch_states_; }
+  const torch::Tensor &BatchActions() const { return batch_actions_; }
+  const torch::Tensor &BatchTargets() const { return batch_targets_; }
+  const torch::Tensor &BatchRewards() const { return batch_rewards_; }
+  const torch::Tensor &BatchNextStates() const { return batch_next_states_; }
+  const torch::Tensor &BatchDiscounts() const { return batch_discounts_; }
+  const torch::Tensor &BatchDones() const { return batch_dones_; }
+
+  bool StoresTransitions() const { return store_transitions_; }
+  bool Bf16States() const { return bf16_states_; }
+
+  std::size_t Size() const { return size_; }
+  std::size_t Capacity() const { return capacity_; }
+
+ private:
+  void WriteState(torch::Tensor &column, const State &state) {
+    if constexpr (std::is_floating_point_v<Feature>) {
+      if (bf16_states_) {
+        auto *row = column.template data_ptr<c10::BFloat16>() +
+                    pos_ * kFeaturesDim;
+        for (int j = 0; j < kFeaturesDim; ++j) {
+          // rounds to nearest even
+          row[j] = c10::BFloat16(static_cast<float>(state[j]));
+        }
+        return;
+      }
+    }
+    std::memcpy(column.template data_ptr<Feature>() + pos_ * kFeaturesDim,
+                state.data(), sizeof(Feature) * kFeaturesDim);
+  }
+
+  void GatherStates(torch::Tensor &batch, const torch::Tensor &column) {
+    if (!bf16_states_) {
+      torch::index_select_out(batch, column, 0, batch_index_);
+      return;
+    }
+    const auto B = batch_index_.size(0);
+    if (gathered_states_.size(0) != B) {
+      gathered_states_.resize_({B, kFeaturesDim});
+    }
+    if (batch.size(0) != B) {
+      batch.resize_({B, kFeaturesDim});
+    }
+    torch::index_select_out(gathered_states_, column, 0, batch_index_);
+    batch.copy_(gathered_states_);
+  }
+
+  std::size_t capacity_;
+  bool store_transitions_;
+  bool bf16_states_;
+  std::size_t size_{0};
+  std::size_t pos_{0};
+  torch::Tensor states_;
+  torch::Tensor actions_;
+  torch::Tensor targets_;
+  torch::Tensor batch_states_;
+  torch::Tensor batch_actions_;
+  torch::Tensor batch_targets_;
+  torch::Tensor batch_index_;
+  torch::Tensor gathered_states_;
+  torch::Tensor rewards_;
+  torch::Tensor next_states_;
+  torch::Tensor discounts_;
+  torch::Tensor dones_;
+  torch::Tensor batch_rewards_;
+  torch::Tensor batch_next_states_;
+  torch::Tensor batch_discounts_;
+  torch::Tensor batch_dones_;
+};
+
+}  // namespace RLlib::Models
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef MODELS_REPLAY_SAMPLER_H
+#define MODELS_REPLAY_SAMPLER_H
+
+#include <models/sum_tree.h>
+#include <schedule.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <extern/json.hpp>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace RLlib::Models {
+
+// Draws minibatch indices from [0, population) in O(count), independent of
+// the population (replay buffer) size. Without replacement uses Floyd's
+// algorithm, so the indices are distinct but not in random order.
+class MinibatchSampler {
+ public:
+  explicit MinibatchSampler(bool with_replacement = false,
+                            std::size_t count_hint = 0)
+      : with_replacement_(with_replacement) {
+    indices_.reserve(count_hint);
+    if (!with_replacement_) {
+      seen_.reserve(count_hint);
+    }
+  }
+
+  template <typename TRng>
+  const std::vector<std::size_t> &Sample(std::size_t population,
+                                         std::size_t count, TRng &rng) {
+    if (population == 0 || (!with_replacement_ && count > population)) {
+      throw std::runtime_error("Cannot sample " + std::to_string(count) +
+                               " indices from a population of " +
+                               std::to_string(population));
+    }
+    indices_.clear();
+    if (with_replacement_) {
+      std::uniform_int_distribution<std::size_t> dist(0, population - 1);
+      for (std::size_t i = 0; i < count; ++i) {
+        indices_.push_back(dist(rng));
+      }
+    } else {
+      seen_.clear();
+      for (std::size_t j = population - count; j < population; ++j) {
+        std::size_t t = std::uniform_int_distribution<std::size_t>(0, j)(rng);
+        if (!seen_.insert(t).second) {
+          // j has not been drawn yet: every earlier draw was below j
+          t = j;
+          seen_.insert(j);
+        }
+        indices_.push_back(t);
+      }
+    }
+    return indices_;
+  }
+
+  bool WithReplacement() const { return with_replacement_; }
+
+  void SetWithReplacement(bool with_replacement) {
+    with_replacement_ = with_replacement;
+  }
+
+ private:
+  bool with_replacement_;
+  std::vector<std::size_t> indices_{};
+  std::unordered_set<std::size_t> seen_{};
+};
+
+enum class PriorityMode { kProportional = 0, kRank = 1, kModesCount = 2 };
+
+constexpr const char *PriorityModeNames[] = {"proportional", "rank"};
+
+inline PriorityMode NameToPriorityMode(std::string_view name) {
+  for (int i = 0; i < static_cast<int>(PriorityMode::kModesCount); ++i) {
+    if (name == PriorityModeNames[i]) {
+      return static_cast<PriorityMode>(i);
+    }
+  }
+  throw std::runtime_error("Invalid PriorityMode name");
+}
+
+// Prioritized experience replay sampling (Schaul et al.) over a SumTree.
+// Proportional mode uses p_i = (|delta_i| + epsilon)^alpha; rank mode uses
+// p_i = rank(i)^-alpha with ranks recomputed every rank_sort_interval
+// samples. Updates are O(log N) in both modes, and so is sampling in
+// proportional mode; rank mode's re-sort makes its sampling cost amortized
+// O(N log N / rank_sort_interval). New slots get the current maximum
+// priority. Sampling is
+// stratified over `count` equal slices of the total mass and also produces
+// normalized importance-sampling weights (p_i / p_min)^-beta, where beta is a
+// Schedule over the number of Sample() calls.
+//
+// Config: {"mode": "proportional", "alpha": 0.6, "beta": 0.4,
+//          "epsilon": 1e-6, "rank_sort_interval": 1000}
+class PrioritizedSampler {
+ public:
+  PrioritizedSampler(std::size_t capacity, const json &config,
+                     std::size_t count_hint = 0)
+      : mode_(NameToPriorityMode(config.value("mode", "proportional"))),
+        alpha_(config.value("alpha", 0.6)),
+        beta_(config.value("beta", json(0.4))),
+        epsilon_(config.value("epsilon", 1e-6)),
+        rank_sort_interval_(config.value("rank_sort_interval",
+                                         static_cast<std::size_t>(1000))),
+        tree_(capacity),
+        errors_(capacity, 0.0) {
+    if (beta_.Empty()) {
+      throw std::runtime_error("Prioritized replay beta must not be empty");
+    }
+    if (epsilon_ <= 0.0) {
+      throw std::runtime_error("Prioritized replay epsilon must be > 0");
+    }
+    if (rank_sort_interval_ == 0) {
+      throw std::runtime_error("rank_sort_interval must be > 0");
+    }
+    indices_.reserve(count_hint);
+    weights_.reserve(count_hint);
+  }
+
+  // Registers a newly written slot with the maximum priority seen so far.
+  void Add(std::size_t idx) {
+    if (idx >= size_) size_ = idx + 1;
+    errors_[idx] = max_error_;
+    tree_.Update(idx, mode_ == PriorityMode::kRank ? 1.0 : max_priority_);
+  }
+
+  template <typename TRng>
+  const std::vector<std::size_t> &Sample(std::size_t count, TRng &rng) {
+    if (size_ == 0) {
+      throw std::runtime_error("Cannot sample from an empty replay");
+    }
+    if (mode_ == PriorityMode::kRank && samples_ % rank_sort_interval_ == 0) {
+      SortRanks();
+    }
+    const double beta = beta_.Value(static_cast<int>(samples_));
+    ++samples_;
+
+    indices_.clear();
+    weights_.clear();
+    const double total = tree_.Total();
+    const double segment = total / static_cast<double>(count);
+    const double min_priority = tree_.Min();
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (std::size_t i = 0; i < count; ++i) {
+      double prefix = (static_cast<double>(i) + dist(rng)) * segment;
+      std::size_t idx = tree_.Find(std::min(prefix, total));
+      indices_.push_back(idx);
+      weights_.push_back(std::pow(tree_.Get(idx) / min_priority, -beta));
+    }
+    return indices_;
+  }
+
+  const std::vector<double> &Weights() const { return weights_; }
+
+  // td_errors[b] belongs to indices[b] as returned by the last Sample().
+  void UpdatePriorities(const std::vector<std::size_t> &indices,
+                        const double *td_errors) {
+    for (std::size_t b = 0; b < indices.size(); ++b) {
+      const double error = std::abs(td_errors[b]) + epsilon_;
+      errors_[indices[b]] = error;
+      if (error > max_error_) max_error_ = error;
+      if (mode_ == PriorityMode::kProportional) {
+        const double priority = std::pow(error, alpha_);
+        if (priority > max_priority_) max_priority_ = priority;
+        tree_.Update(indices[b], priority);
+      }
+    }
+  }
+
+  PriorityMode Mode() const { return mode_; }
+  const SumTree &Tree() const { return tree_; }
+
+ private:
+  void SortRanks() {
+    order_.resize(size_);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(),
+              [this](std::size_t a, std::size_t b) {
+                return errors_[a] > errors_[b];
+              });
+    // rank^-alpha only depends on the rank, so it is computed once per rank
+    for (std::size_t r = rank_priorities_.size(); r < size_; ++r) {
+      rank_priorities_.push_back(
+          std::pow(static_cast<double>(r + 1), -alpha_));
+    }
+    priorities_.resize(size_);
+    for (std::size_t r = 0; r < size_; ++r) {
+      priorities_[order_[r]] = rank_priorities_[r];
+    }
+    tree_.Build(priorities_.data(), size_);
+  }
+
+  PriorityMode mode_;
+  double alpha_;
+  Schedule beta_;
+  double epsilon_;
+  std::size_t rank_sort_interval_;
+  SumTree tree_;
+  std::vector<double> errors_;
+  std::vector<std::size_t> order_{};
+  std::vector<double> rank_priorities_{};
+  std::vector<double> priorities_{};
+  std::vector<std::size_t> indices_{};
+  std::vector<double> weights_{};
+  std::size_t size_{0};
+  std::size_t samples_{0};
+  double max_priority_{1.0};
+  double max_error_{1.0};
+};
+
+}  // namespace RLlib::Models
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef MODELS_SPARSE_FEATURES_H
+#define MODELS_SPARSE_FEATURES_H
+#include <agent.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace RLlib::Models {
+
+// One active feature of a sparse state.
+struct SparseFeature {
+  std::uint32_t index{};
+  double value{};
+};
+
+// The active features of a state, at most tMaxActive of them, stored inline
+// so states copy without allocating. Indices may repeat; their values add.
+template <int tMaxActive>
+struct SparseState {
+  static constexpr int kMaxActive = tMaxActive;
+
+  std::array<SparseFeature, kMaxActive> features{};
+  int size{0};
+
+  void Clear() { size = 0; }
+
+  void Add(std::uint32_t index, double value) {
+    if (size == kMaxActive) {
+      throw std::runtime_error("SparseState is full");
+    }
+    features[size++] = SparseFeature{index, value};
+  }
+
+  int Size() const { return size; }
+  const SparseFeature *begin() const { return features.data(); }
+  const SparseFeature *end() const { return features.data() + size; }
+};
+
+// murmur3's 64-bit finalizer: every input bit affects every output bit.
+inline std::uint64_t MixBits(std::uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+// Tile coding of a tDims-dimensional continuous observation: tTilings
+// overlapping grids, each offset from the previous one by a fraction of a
+// tile (asymmetrically, by (1, 3, 5, ...) / tTilings along the dimensions),
+// so every observation activates exactly one tile per tiling, with value 1.
+// Observations are clipped to [low, high].
+//
+// Tile t of tiling k gets index k * TilesPerTiling() + t, for Size() =
+// tTilings * prod(tiles + 1) features in total. With "size" the tile
+// coordinates are hashed into [0, size) instead, for grids too large to
+// index densely.
+//
+// config keys: "low", "high" (a number for every dimension, or one per
+// dimension), "tiles" (tiles per dimension across [low, high], likewise),
+// "size" and "seed" (hashing only).
+template <int tDims, int tTilings>
+class TileCoder {
+ public:
+  static constexpr int kDims = tDims;
+  static constexpr int kTilings = tTilings;
+  using Observation = std::array<double, kDims>;
+  using State = SparseState<kTilings>;
+
+  explicit TileCoder(const json &config) {
+    static_assert(kDims > 0 && kTilings > 0, "need dimensions and tilings");
+    const auto low = PerDimension(config, "low");
+    const auto high = PerDimension(config, "high");
+    const auto tiles = PerDimension(config, "tiles");
+    double cells = 1.0;
+    for (int d = 0; d < kDims; ++d) {
+      if (!(high[d] > low[d])) {
+        throw std::runtime_error("TileCoder needs high > low");
+      }
+      tiles_[d] = static_cast<int>(tiles[d]);
+      if (tiles_[d] < 1) {
+        throw std::runtime_error("TileCoder needs at least one tile");
+      }
+      low_[d] = low[d];
+      scale_[d] = tiles_[d] / (high[d] - low[d]);
+      for (int k = 0; k < kTilings; ++k) {
+        offsets_[k][d] =
+            static_cast<double>((k * (2 * d + 1)) % kTilings) / kTilings;
+      }
+      cells *= tiles_[d] + 1;
+    }
+
+    constexpr auto kMaxIndex = std::numeric_limits<std::uint32_t>::max();
+    if (config.contains("size")) {
+      size_ = config["size"].get<std::uint64_t>();
+      if (size_ == 0 || size_ > kMaxIndex) {
+        throw std::runtime_error("TileCoder size must be in [1, 2^32)");
+      }
+      hashed_ = true;
+      seed_ = config.value("seed", std::uint64_t{0});
+    } else {
+      if (cells * kTilings > kMaxIndex) {
+        throw std::runtime_error(
+            "TileCoder grid too large to index densely, set \"size\"");
+      }
+      tiles_per_tiling_ = static_cast<std::uint64_t>(cells);
+      size_ = tiles_per_tiling_ * kTilings;
+    }
+  }
+
+  // Number of distinct feature indices.
+  std::uint64_t Size() const { return size_; }
+  std::uint64_t TilesPerTiling() const { return tiles_per_tiling_; }
+  bool Hashed() const { return hashed_; }
+
+  void Encode(const Observation &x, State &out) const {
+    std::array<double, kDims> scaled;
+    for (int d = 0; d < kDims; ++d) {
+      scaled[d] = std::clamp((x[d] - low_[d]) * scale_[d], 0.0,
+                             static_cast<double>(tiles_[d]));
+    }
+    out.Clear();
+    for (int k = 0; k < kTilings; ++k) {
+      std::uint64_t index = 0;
+      std::uint64_t h = seed_ ^ MixBits(static_cast<std::uint64_t>(k) + 1);
+      for (int d = 0; d < kDims; ++d) {
+        // in [0, tiles]: the offset grids need one extra tile
+        const auto coord =
+            static_cast<std::uint64_t>(scaled[d] + offsets_[k][d]);
+        index = index * (tiles_[d] + 1) + coord;
+        h = MixBits(h + coord);
+      }
+      out.Add(static_cast<std::uint32_t>(
+                  hashed_ ? h % size_ : k * tiles_per_tiling_ + index),
+              1.0);
+    }
+  }
+
+  State Encode(const Observation &x) const {
+    State out;
+    Encode(x, out);
+    return out;
+  }
+
+ private:
+  static std::array<double, kDims> PerDimension(const json &config,
+                                                const char *key) {
+    if (!config.contains(key)) {
+      throw std::runtime_error(std::string("TileCoder needs \"") + key +
+                               "\"");
+    }
+    const auto &value = config[key];
+    std::array<double, kDims> out;
+    if (value.is_number()) {
+      out.fill(value.get<double>());
+    } else if (value.is_array() && value.size() == kDims) {
+      for (int d = 0; d < kDims; ++d) out[d] = value[d].get<double>();
+    } else {
+      throw std::runtime_error(std::string("Invalid TileCoder \"") + key +
+                               "\"");
+    }
+    return out;
+  }
+
+  std::array<double, kDims> low_{};
+  std::array<double, kDims> scale_{};
+  std::array<int, kDims> tiles_{};
+  std::array<std::array<double, kDims>, kTilings> offsets_{};
+  std::uint64_t tiles_per_tiling_{0};
+  std::uint64_t size_{0};
+  bool hashed_{false};
+  std::uint64_t seed_{0};
+};
+
+// The hashing trick for a tInputs-dimensional observation: input i lands on
+// feature index hash(i) mod size, multiplied by a hashed sign (unless
+// "signed" is false) so that collisions cancel out in expectation rather
+// than add up. Zero inputs produce no feature. Arbitrary keys, e.g. crossed
+// or categorical features, can be added with AddKey().
+//
+// config keys: "size" (required), "signed" (default true), "seed".
+template <int tInputs>
+class FeatureHasher {
+ public:
+  static constexpr int kInputs = tInputs;
+  using Observation = std::array<double, kInputs>;
+  using State = SparseState<kInputs>;
+
+  explicit FeatureHasher(const json &config)
+      : size_(config.at("size").get<std::uint64_t>()),
+        signed_(config.value("signed", true)),
+        seed_(config.value("seed", std::uint64_t{0})) {
+    if (size_ == 0 || size_ > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error("FeatureHasher size must be in [1, 2^32)");
+    }
+    // the input positions are fixed, so hash them once
+    for (int i = 0; i < kInputs; ++i) {
+      Place(static_cast<std::uint64_t>(i), indices_[i], signs_[i]);
+    }
+  }
+
+  std::uint64_t Size() const { return size_; }
+
+  void Encode(const Observation &x, State &out) const {
+    out.Clear();
+    for (int i = 0; i < kInputs; ++i) {
+      if (x[i] != 0.0) out.Add(indices_[i], signs_[i] * x[i]);
+    }
+  }
+
+  State Encode(const Observation &x) const {
+    State out;
+    Encode(x, out);
+    return out;
+  }
+
+  // Adds a feature identified by an arbitrary key (hashed on the fly).
+  template <int tMaxActive>
+  void AddKey(SparseState<tMaxActive> &out, std::uint64_t key,
+              double value) const {
+    std::uint32_t index;
+    double sign;
+    // offset past the input positions' keys
+    Place(key + kInputs, index, sign);
+    out.Add(index, sign * value);
+  }
+
+ private:
+  void Place(std::uint64_t key, std::uint32_t &index, double &sign) const {
+    const std::uint64_t h = MixBits(MixBits(key) ^ seed_);
+    index = static_cast<std::uint32_t>(h % size_);
+    sign = (signed_ && (h >> 63)) ? -1.0 : 1.0;
+  }
+
+  std::uint64_t size_;
+  bool signed_;
+  std::uint64_t seed_;
+  std::array<std::uint32_t, kInputs> indices_{};
+  std::array<double, kInputs> signs_{};
+};
+
+}  // namespace RLlib::Models
+#endif
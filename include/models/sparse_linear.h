@@ -0,0 +1,165 @@
+#ifndef MODELS_SPARSE_LINEAR_H
+#define MODELS_SPARSE_LINEAR_H
+#include <agent.h>
+#include <checkpoint.h>
+#include <models/sparse_features.h>
+#include <random_generator.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RLlib::Models {
+
+// Linear action values over a large, sparsely active feature space (tile
+// codes, hashed features): the state lists its active (index, value) pairs
+// and Q(s, a) = sum_i w[i][a] * x_i over them, so forward and update cost
+// O(active features * actions) however many features there are.
+//
+// Unlike SimpleLinearModel the weights are stored feature-major, as a
+// [kFeaturesDim, kActionsDim] matrix on the heap, so the forward reads one
+// short contiguous row per active feature.
+//
+// config keys: "weights" (a number, or {"mean", "stddev"}) and
+// "learning_rate".
+template <int tFeaturesDim, int tActionsDim, int tMaxActive,
+          typename TWeight = double>
+class SparseLinearModel {
+ public:
+  static constexpr int kFeaturesDim = tFeaturesDim;
+  static constexpr int kActionsDim = tActionsDim;
+  static constexpr int kMaxActive = tMaxActive;
+  using Weight = TWeight;
+  using Result = double;
+  using State = SparseState<kMaxActive>;
+  using ResultsList = std::array<Result, kActionsDim>;
+
+  SparseLinearModel() : weights_(kSize, Weight{}) {}
+  SparseLinearModel(const json &config) : weights_(kSize) {
+    const auto &init = config["weights"];
+    if (init.is_number()) {
+      std::fill(weights_.begin(), weights_.end(), init.get<Weight>());
+    } else if (init.is_object() && init.contains("mean") &&
+               init.contains("stddev")) {
+      const double mean = init["mean"].get<double>();
+      const double stddev = init["stddev"].get<double>();
+      for (auto &w : weights_) {
+        w = static_cast<Weight>(rng_util::normal(mean, stddev));
+      }
+    } else {
+      throw std::runtime_error("Invalid weights format in config JSON");
+    }
+
+    if (config.contains("learning_rate")) {
+      if (config["learning_rate"].is_number()) {
+        alpha_ = config["learning_rate"].get<double>();
+      } else {
+        throw std::runtime_error("Invalid learning_rate format in config JSON");
+      }
+    }
+  }
+
+  const ResultsList &GetActionValues(const State &state) {
+    results_.fill(Result{});
+    for (const auto &f : state) {
+      const Weight *w = Row(f.index);
+      for (int a = 0; a < kActionsDim; ++a) {
+        results_[a] += w[a] * f.value;
+      }
+    }
+    return results_;
+  }
+
+  Result GetActionValue(const State &state, int action_idx) {
+    Result q{};
+    for (const auto &f : state) q += Row(f.index)[action_idx] * f.value;
+    return q;
+  }
+
+  void Update(const State &state, int action_idx, double td_target) {
+    const double step =
+        alpha_ * (td_target - GetActionValue(state, action_idx));
+    for (const auto &f : state) {
+      weights_[f.index * std::size_t{kActionsDim} + action_idx] +=
+          static_cast<Weight>(step * f.value);
+    }
+  }
+
+  void SetLearningRate(double alpha) { alpha_ = alpha; }
+
+  // One "w_0,...,w_{A-1}" record per feature.
+  void OutputModel(std::string_view fname, char delimiter = '\n',
+                   bool append = false) const {
+    std::ofstream ofs(fname.data(), append ? std::ios::app : std::ios::out);
+    if (!ofs.is_open()) {
+      throw std::runtime_error("Failed to open output file");
+    }
+    for (int i = 0; i < kFeaturesDim; ++i) {
+      const Weight *w = weights_.data() + i * std::size_t{kActionsDim};
+      for (int a = 0; a < kActionsDim; ++a) {
+        ofs << w[a];
+        if (a != kActionsDim - 1) {
+          ofs << ",";
+        }
+      }
+      if (i != kFeaturesDim - 1) {
+        ofs << delimiter;
+      }
+    }
+    ofs << '\n';
+  }
+
+  void LoadModel(std::string_view fname, char delimiter = '\n') {
+    std::ifstream ifs(fname.data());
+    if (!ifs.is_open()) {
+      throw std::runtime_error("Failed to open input file");
+    }
+    for (auto it = weights_.begin(); it != weights_.end();) {
+      for (int a = 0; a < kActionsDim; ++a, ++it) {
+        ifs >> *it;
+        if (ifs.peek() == ',') {
+          ifs.ignore();
+        }
+      }
+      if (ifs.peek() == delimiter) {
+        ifs.ignore();
+      }
+    }
+  }
+
+  // row-major [kFeaturesDim, kActionsDim]
+  const Weight *ParameterData() const { return weights_.data(); }
+
+  std::size_t MemoryBytes() const { return weights_.size() * sizeof(Weight); }
+
+  void SaveCheckpoint(std::string_view fname) const {
+    Checkpoint::Save(fname, kFeaturesDim, kActionsDim, weights_.data());
+  }
+
+  void LoadCheckpoint(std::string_view fname) {
+    Checkpoint::Load(fname, kFeaturesDim, kActionsDim, weights_.data());
+  }
+
+ private:
+  static constexpr std::size_t kSize =
+      std::size_t{kFeaturesDim} * std::size_t{kActionsDim};
+
+  const Weight *Row(std::uint32_t index) const {
+    if (index >= static_cast<std::uint32_t>(kFeaturesDim)) {
+      throw std::runtime_error("Sparse feature index " +
+                               std::to_string(index) + " out of range");
+    }
+    return weights_.data() + index * std::size_t{kActionsDim};
+  }
+
+  std::vector<Weight> weights_;
+  ResultsList results_{};
+  double alpha_{1.0};
+};
+
+}  // namespace RLlib::Models
+#endif
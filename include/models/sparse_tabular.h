@@ -0,0 +1,276 @@
+#ifndef MODELS_SPARSE_TABULAR_H
+#define MODELS_SPARSE_TABULAR_H
+#include <agent.h>
+#include <checkpoint.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "random_generator.h"
+
+namespace RLlib::Models {
+
+// Tabular action values for state spaces too large to allocate densely: only
+// states that have been updated get a row. Rows live in an open-addressing
+// hash table with linear probing, keys and rows in separate arrays so a
+// probe only walks the compact key array. A state never written reads as the
+// initial value without being inserted, except with random initial values,
+// which are drawn (and the row stored) the first time the state is seen.
+//
+// config keys: "action_values" (a number, or {"mean", "stddev"}),
+// "learning_rate", "initial_capacity" (default 1024) and "max_load_factor"
+// (default 0.5).
+template <int tActionsDim, typename TState = std::uint64_t>
+class SparseTabular {
+ public:
+  static_assert(std::is_integral_v<TState>, "States must be integers");
+  static constexpr int kActionsDim = tActionsDim;
+  using State = TState;
+  using Action = int;
+  using Reward = double;
+  using ResultsList = std::array<double, kActionsDim>;
+
+  SparseTabular() { Rehash(kDefaultCapacity); }
+  SparseTabular(const json &config) {
+    const auto &init = config["action_values"];
+    if (init.is_number()) {
+      default_row_.fill(init.get<double>());
+    } else if (init.is_object() && init.contains("mean") &&
+               init.contains("stddev")) {
+      random_init_ = true;
+      mean_ = init["mean"].get<double>();
+      stddev_ = init["stddev"].get<double>();
+    } else {
+      throw std::runtime_error("Invalid action_values format in config JSON");
+    }
+
+    if (config.contains("learning_rate")) {
+      if (config["learning_rate"].is_number()) {
+        alpha_ = config["learning_rate"].get<double>();
+      } else {
+        throw std::runtime_error("Invalid learning_rate format in config JSON");
+      }
+    }
+    max_load_factor_ = config.value("max_load_factor", 0.5);
+    if (!(max_load_factor_ > 0.0 && max_load_factor_ < 1.0)) {
+      throw std::runtime_error("max_load_factor must be in (0, 1)");
+    }
+    Rehash(std::bit_ceil(
+        config.value("initial_capacity", std::size_t{kDefaultCapacity})));
+  }
+
+  const ResultsList &GetActionValues(State state) {
+    if (random_init_) return FindOrInsert(state);
+    const std::size_t slot = Find(state);
+    return slot == kNotFound ? default_row_ : rows_[slot];
+  }
+
+  double GetActionValue(State state, int action_idx) const {
+    const std::size_t slot = Find(state);
+    return slot == kNotFound ? default_row_[action_idx]
+                             : rows_[slot][action_idx];
+  }
+
+  void Update(State state, int action_idx, double td_target) {
+    double &value = FindOrInsert(state)[action_idx];
+    value += alpha_ * (td_target - value);
+  }
+
+  void SetLearningRate(double alpha) { alpha_ = alpha; }
+
+  bool Contains(State state) const { return Find(state) != kNotFound; }
+
+  // Number of stored states.
+  std::size_t Size() const { return size_; }
+  std::size_t Capacity() const { return keys_.size(); }
+  double LoadFactor() const {
+    return static_cast<double>(size_) / static_cast<double>(keys_.size());
+  }
+
+  // Heap bytes held by the table.
+  std::size_t MemoryBytes() const {
+    return keys_.capacity() * sizeof(std::uint64_t) +
+           rows_.capacity() * sizeof(ResultsList);
+  }
+
+  // What a dense table over `states` states would need.
+  static std::size_t DenseBytes(std::uint64_t states) {
+    return states * sizeof(ResultsList);
+  }
+
+  void MemoryReport(std::ostream &os) const {
+    os << "states: " << size_ << ", slots: " << keys_.size()
+       << ", load: " << LoadFactor() << ", bytes: " << MemoryBytes()
+       << ", bytes/state: "
+       << (size_ ? MemoryBytes() / size_ : std::size_t{0}) << std::endl;
+  }
+
+  // Calls fn(state, values) for every stored state, in table order.
+  template <typename TFunc>
+  void ForEach(TFunc &&fn) const {
+    for (std::size_t slot = 0; slot < keys_.size(); ++slot) {
+      if (keys_[slot] != kEmpty) {
+        fn(static_cast<State>(keys_[slot]), rows_[slot]);
+      }
+    }
+  }
+
+  // One "state,v_0,...,v_{A-1}" record per stored state.
+  void OutputModel(std::string_view fname, char delimiter = '\n',
+                   bool append = false) const {
+    std::ofstream ofs(fname.data(), append ? std::ios::app : std::ios::out);
+    if (!ofs.is_open()) {
+      throw std::runtime_error("Failed to open output file");
+    }
+    bool first = true;
+    ForEach([&](State state, const ResultsList &values) {
+      if (!first) ofs << delimiter;
+      first = false;
+      ofs << state;
+      for (double v : values) ofs << "," << v;
+    });
+    ofs << '\n';
+  }
+
+  void LoadModel(std::string_view fname, char delimiter = '\n') {
+    std::ifstream ifs(fname.data());
+    if (!ifs.is_open()) {
+      throw std::runtime_error("Failed to open input file");
+    }
+    Clear();
+    State state;
+    while (ifs >> state) {
+      auto &row = FindOrInsert(state);
+      for (auto &v : row) {
+        if (ifs.peek() == ',') ifs.ignore();
+        ifs >> v;
+      }
+      if (ifs.peek() == delimiter) ifs.ignore();
+    }
+  }
+
+  // Stored as a [Size(), 1 + kActionsDim] float64 matrix whose first column
+  // holds the state's bit pattern.
+  void SaveCheckpoint(std::string_view fname) const {
+    std::vector<double> data;
+    data.reserve(size_ * (kActionsDim + 1));
+    ForEach([&](State state, const ResultsList &values) {
+      data.push_back(
+          std::bit_cast<double>(static_cast<std::uint64_t>(state)));
+      data.insert(data.end(), values.begin(), values.end());
+    });
+    Checkpoint::Save(fname, size_, kActionsDim + 1, data.data());
+  }
+
+  void LoadCheckpoint(std::string_view fname) {
+    Checkpoint::MappedFile file(fname);
+    const auto rows = file.GetHeader().rows;
+    const double *data = file.Data<double>(rows, kActionsDim + 1);
+    Clear();
+    Rehash(std::bit_ceil(static_cast<std::size_t>(
+        static_cast<double>(rows) / max_load_factor_ + 1)));
+    for (std::uint64_t r = 0; r < rows; ++r) {
+      const double *record = data + r * (kActionsDim + 1);
+      auto &row = FindOrInsert(
+          static_cast<State>(std::bit_cast<std::uint64_t>(record[0])));
+      std::copy(record + 1, record + 1 + kActionsDim, row.begin());
+    }
+  }
+
+  void Clear() {
+    std::fill(keys_.begin(), keys_.end(), kEmpty);
+    size_ = 0;
+  }
+
+ private:
+  static constexpr std::size_t kDefaultCapacity = 1024;
+  static constexpr std::size_t kMinCapacity = 8;
+  static constexpr std::size_t kNotFound =
+      std::numeric_limits<std::size_t>::max();
+  // reserved: the one key no state may map to
+  static constexpr std::uint64_t kEmpty =
+      std::numeric_limits<std::uint64_t>::max();
+
+  // Fibonacci hashing on the top bits: sequential states spread out.
+  std::size_t Home(std::uint64_t key) const {
+    return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> shift_);
+  }
+
+  std::size_t Find(State state) const {
+    const auto key = static_cast<std::uint64_t>(state);
+    const std::size_t mask = keys_.size() - 1;
+    for (std::size_t slot = Home(key);; slot = (slot + 1) & mask) {
+      if (keys_[slot] == key) return slot;
+      if (keys_[slot] == kEmpty) return kNotFound;
+    }
+  }
+
+  ResultsList &FindOrInsert(State state) {
+    const auto key = static_cast<std::uint64_t>(state);
+    if (key == kEmpty) {
+      throw std::runtime_error("State collides with the empty-slot marker");
+    }
+    std::size_t mask = keys_.size() - 1;
+    std::size_t slot = Home(key);
+    for (; keys_[slot] != kEmpty; slot = (slot + 1) & mask) {
+      if (keys_[slot] == key) return rows_[slot];
+    }
+    if (static_cast<double>(size_ + 1) >
+        max_load_factor_ * static_cast<double>(keys_.size())) {
+      Rehash(keys_.size() * 2);
+      mask = keys_.size() - 1;
+      for (slot = Home(key); keys_[slot] != kEmpty; slot = (slot + 1) & mask) {
+      }
+    }
+    keys_[slot] = key;
+    ++size_;
+    auto &row = rows_[slot];
+    if (random_init_) {
+      for (auto &v : row) v = rng_util::normal(mean_, stddev_);
+    } else {
+      row = default_row_;
+    }
+    return row;
+  }
+
+  // capacity must be a power of two
+  void Rehash(std::size_t capacity) {
+    capacity = std::max(capacity, kMinCapacity);
+    std::vector<std::uint64_t> keys(capacity, kEmpty);
+    std::vector<ResultsList> rows(capacity);
+    keys_.swap(keys);
+    rows_.swap(rows);
+    shift_ = 64 - std::countr_zero(capacity);
+    const std::size_t mask = capacity - 1;
+    for (std::size_t old = 0; old < keys.size(); ++old) {
+      if (keys[old] == kEmpty) continue;
+      std::size_t slot = Home(keys[old]);
+      while (keys_[slot] != kEmpty) slot = (slot + 1) & mask;
+      keys_[slot] = keys[old];
+      rows_[slot] = rows[old];
+    }
+  }
+
+  std::vector<std::uint64_t> keys_;
+  std::vector<ResultsList> rows_;
+  std::size_t size_{0};
+  int shift_{64};
+  double max_load_factor_{0.5};
+  double alpha_{1.0};
+  ResultsList default_row_{};
+  bool random_init_{false};
+  double mean_{0.0};
+  double stddev_{0.0};
+};
+}  // namespace RLlib::Models
+#endif
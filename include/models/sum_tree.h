@@ -0,0 +1,99 @@
+#ifndef MODELS_SUM_TREE_H
+#define MODELS_SUM_TREE_H
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace RLlib::Models {
+
+// Segment tree over non-negative priorities keeping subtree sums and minima.
+// Nodes live in one flat array in heap order (root at 1, leaves at
+// [leaves_, 2 * leaves_)), with sum and min interleaved so a root-to-leaf walk
+// touches one cache line per level. Update and Find are O(log N); Build
+// replaces all priorities at once in O(N).
+class SumTree {
+ public:
+  explicit SumTree(std::size_t capacity) : capacity_(capacity) {
+    if (capacity_ == 0) {
+      throw std::runtime_error("SumTree capacity must be > 0");
+    }
+    while (leaves_ < capacity_) leaves_ <<= 1;
+    nodes_.assign(2 * leaves_, Node{});
+  }
+
+  void Update(std::size_t idx, double priority) {
+    if (priority < 0.0) {
+      throw std::runtime_error("SumTree priorities must be non-negative");
+    }
+    std::size_t node = idx + leaves_;
+    nodes_[node] = Node{priority, priority};
+    for (node >>= 1; node >= 1; node >>= 1) {
+      const Node &l = nodes_[2 * node];
+      const Node &r = nodes_[2 * node + 1];
+      nodes_[node] = Node{l.sum + r.sum, l.min < r.min ? l.min : r.min};
+    }
+  }
+
+  // Sets the priorities of leaves [0, count) to priorities[0, count) and
+  // empties the rest, rebuilding the inner nodes bottom-up.
+  void Build(const double *priorities, std::size_t count) {
+    if (count > capacity_) {
+      throw std::runtime_error("SumTree Build past capacity");
+    }
+    for (std::size_t i = 0; i < leaves_; ++i) {
+      if (i < count && priorities[i] < 0.0) {
+        throw std::runtime_error("SumTree priorities must be non-negative");
+      }
+      nodes_[leaves_ + i] =
+          i < count ? Node{priorities[i], priorities[i]} : Node{};
+    }
+    for (std::size_t node = leaves_ - 1; node >= 1; --node) {
+      const Node &l = nodes_[2 * node];
+      const Node &r = nodes_[2 * node + 1];
+      nodes_[node] = Node{l.sum + r.sum, l.min < r.min ? l.min : r.min};
+    }
+  }
+
+  double Get(std::size_t idx) const { return nodes_[idx + leaves_].sum; }
+
+  double Total() const { return nodes_[1].sum; }
+
+  // smallest stored priority; +inf while the tree is empty
+  double Min() const { return nodes_[1].min; }
+
+  // Leaf whose cumulative priority range contains prefix, for prefix in
+  // [0, Total()).
+  std::size_t Find(double prefix) const {
+    std::size_t node = 1;
+    while (node < leaves_) {
+      const std::size_t left = 2 * node;
+      // rounding can leave prefix just past the left sum with an empty right
+      // subtree; never descend into zero mass
+      if (prefix < nodes_[left].sum || nodes_[left + 1].sum <= 0.0) {
+        node = left;
+      } else {
+        prefix -= nodes_[left].sum;
+        node = left + 1;
+      }
+    }
+    return node - leaves_;
+  }
+
+  std::size_t Capacity() const { return capacity_; }
+
+ private:
+  struct Node {
+    double sum{0.0};
+    double min{std::numeric_limits<double>::infinity()};
+  };
+
+  std::size_t capacity_;
+  std::size_t leaves_{1};
+  std::vector<Node> nodes_;
+};
+
+}  // namespace RLlib::Models
+
+#endif
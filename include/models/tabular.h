@@ -1,9 +1,12 @@
 #ifndef MODELS_TABULAR_H
 #define MODELS_TABULAR_H
 #include <agent.h>
+#include <checkpoint.h>
+#include <models/eligibility_traces.h>
 
 #include <array>
 #include <fstream>
+#include <optional>
 #include <string_view>
 
 #include "random_generator.h"
@@ -43,38 +46,67 @@ class Tabular {
     } else if (config["action_values"].is_object()) {
       if (config["action_values"].contains("mean") &&
           config["action_values"].contains("stddev")) {
-        double mean = config["weights"]["mean"].get<double>();
-        double stddev = config["weights"]["stddev"].get<double>();
+        double mean = config["action_values"]["mean"].get<double>();
+        double stddev = config["action_values"]["stddev"].get<double>();
         for (auto &values : action_values_) {
           for (auto &val : values) {
             val = static_cast<double>(rng_util::normal(mean, stddev));
           }
         }
       } else {
-        throw std::runtime_error("Invalid weights format in config JSON");
+        throw std::runtime_error("Invalid action_values format in config JSON");
       }
     } else {
       throw std::runtime_error("Invalid action_values format in config JSON");
     }
 
     if (config.contains("learning_rate")) {
-      if (!config["learning_rate"].is_number()) {
+      if (config["learning_rate"].is_number()) {
         alpha_ = config["learning_rate"].get<double>();
       } else {
         throw std::runtime_error("Invalid learning_rate format in config JSON");
       }
     }
+
+    if (config.contains("eligibility_traces")) {
+      traces_.emplace(kStatesDim * kActionsDim, config["eligibility_traces"]);
+    }
   }
 
   const ResultsList &GetActionValues(State state) {
     return action_values_[state];
   }
 
+  double GetActionValue(State state, int action_idx) const {
+    return action_values_[state][action_idx];
+  }
+
   void Update(State state, int action_idx, double td_target) {
     double error_ = td_target - action_values_[state][action_idx];
     action_values_[state][action_idx] += alpha_ * error_;
   }
 
+  bool HasTraces() const { return traces_.has_value(); }
+
+  // One backward-view TD(lambda) step: marks (state, action_idx) eligible,
+  // moves every entry with a live trace by alpha * error * trace, then
+  // decays the traces by gamma * lambda.
+  void TraceUpdate(State state, int action_idx, double td_target,
+                   double gamma) {
+    const double step =
+        alpha_ * (td_target - action_values_[state][action_idx]);
+    traces_->Visit(static_cast<std::size_t>(state) * kActionsDim + action_idx);
+    double *q = action_values_[0].data();
+    traces_->Apply(gamma * traces_->Lambda(),
+                   [q, step](std::size_t i, double trace) {
+                     q[i] += step * trace;
+                   });
+  }
+
+  void ClearTraces() {
+    if (traces_) traces_->Clear();
+  }
+
   void SetLearningRate(double alpha) { alpha_ = alpha; }
 
   const QType &GetActionValues() const { return action_values_; }
@@ -117,9 +149,21 @@ class Tabular {
     }
   }
 
+  // row-major [kStatesDim, kActionsDim]
+  const double *ParameterData() const { return action_values_[0].data(); }
+
+  void SaveCheckpoint(std::string_view fname) const {
+    Checkpoint::Save(fname, kStatesDim, kActionsDim, action_values_[0].data());
+  }
+
+  void LoadCheckpoint(std::string_view fname) {
+    Checkpoint::Load(fname, kStatesDim, kActionsDim, action_values_[0].data());
+  }
+
  private:
   double alpha_{1.0};
   QType action_values_{};
+  std::optional<EligibilityTraces> traces_{};
 };
 }  // namespace RLlib::Models
 #endif
\ No newline at end of file
@@ -6,13 +6,38 @@
 #include <torch/torch.h>
 
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace RLlib::Models {
 
+// With "inference": {"freeze", "optimize", "warmup", "refresh_warmup"}
+// acting runs on a second, inference-only copy of the TorchScript module: a
+// clone put in eval mode, frozen (parameters folded into the graph as
+// constants) and, with "optimize", passed through optimize_for_inference.
+// Single-state calls reuse one preallocated [1, kFeaturesDim] input, and the
+// copy is run "warmup" times when built at construction or LoadModel so the
+// profiling executor has specialized the graph before the first real step.
+//
+// forward() and parameters() keep using the trainable module. Since the
+// frozen copy does not see later parameter updates, it is only used while the
+// parameters' version counters are unchanged since it was built; otherwise
+// acting falls back to the trainable module until RefreshInference() builds a
+// new copy. OffPolicyReplayLearner refreshes whenever it copies parameters
+// into another network, so the copy only pays off on networks that change by
+// whole copies: async snapshots and hard-synced targets. The network a
+// synchronous learner trains, and a soft target, go stale after their first
+// update and act on the trainable module from then on.
+//
+// A refresh clones, freezes and optimizes on the caller's (the learner's)
+// thread, but runs the copy only "refresh_warmup" times (default 0): the
+// first steps after it pay for the re-specialization instead.
 template <int tFeaturesDim, int tActionsDim, typename TFeature = double,
           typename TResult = double>
 class JITNetwork : public torch::nn::Module {
@@ -41,6 +66,37 @@ class JITNetwork : public torch::nn::Module {
     }
 
     results_.fill(Result{0});
+
+    input_ = torch::zeros({1, kFeaturesDim},
+                          torch::TensorOptions()
+                              .dtype(torch::CppTypeToScalarType<Feature>::value)
+                              .device(torch::kCPU));
+    inputs_.emplace_back(input_);
+
+    if (config.contains("inference")) {
+      const auto &inference = config["inference"];
+      inference_ = true;
+      freeze_ = inference.value("freeze", true);
+      optimize_ = inference.value("optimize", true);
+      warmup_ = inference.value("warmup", 10);
+      refresh_warmup_ = inference.value("refresh_warmup", 0);
+      if (warmup_ < 0 || refresh_warmup_ < 0) {
+        throw std::runtime_error("inference warmup must be >= 0");
+      }
+      BuildInference(warmup_);
+    }
+  }
+
+  // Rebuilds the inference copy from the current parameters.
+  void RefreshInference() { BuildInference(refresh_warmup_); }
+
+  // Whether acting currently runs on the inference copy.
+  bool InferenceReady() const {
+    if (!inference_model_) return false;
+    for (std::size_t i = 0; i < frozen_params_.size(); ++i) {
+      if (frozen_params_[i]._version() != frozen_versions_[i]) return false;
+    }
+    return true;
   }
 
   torch::Tensor forward(const torch::Tensor &X) {
@@ -51,6 +107,18 @@ class JITNetwork : public torch::nn::Module {
   }
 
   const ResultsList &GetActionValues(const State &state, bool semigrad = true) {
+    if (InferenceReady()) {
+      torch::NoGradGuard no_grad;
+      std::memcpy(input_.template data_ptr<Feature>(), state.data(),
+                  sizeof(State));
+      auto q = inference_model_->forward(inputs_).toTensor().to(torch::kCPU);
+      auto acc = q.template accessor<Feature, 2>();
+      for (int i = 0; i < kActionsDim; ++i) {
+        results_[i] = static_cast<Result>(acc[0][i]);
+      }
+      return results_;
+    }
+
     const auto opts = torch::TensorOptions()
                           .dtype(torch::CppTypeToScalarType<Feature>::value)
                           .device(torch::kCPU);
@@ -66,10 +134,10 @@ class JITNetwork : public torch::nn::Module {
 
       auto q = out.squeeze(0);
       auto q_cpu = q.to(torch::kCPU);
-      auto acc = q_cpu.template accessor<TResult, 1>();
+      auto acc = q_cpu.template accessor<Feature, 1>();
 
       for (int i = 0; i < kActionsDim; ++i) {
-        results_[i] = acc[i];
+        results_[i] = static_cast<Result>(acc[i]);
       }
     };
 
@@ -83,6 +151,33 @@ class JITNetwork : public torch::nn::Module {
     return results_;
   }
 
+  // One [N, kFeaturesDim] forward for N states.
+  const std::vector<ResultsList> &GetBatchActionValues(
+      const std::vector<State> &states) {
+    torch::NoGradGuard no_grad;
+    const auto opts = torch::TensorOptions()
+                          .dtype(torch::CppTypeToScalarType<Feature>::value)
+                          .device(torch::kCPU);
+    const auto N = static_cast<int64_t>(states.size());
+    auto input = torch::from_blob(const_cast<State *>(states.data()),
+                                  std::array<int64_t, 2>{N, kFeaturesDim},
+                                  opts);
+
+    std::vector<torch::jit::IValue> inputs;
+    inputs.emplace_back(input);
+    auto &module = InferenceReady() ? *inference_model_ : model_;
+    auto q = module.forward(inputs).toTensor().to(torch::kCPU);
+    auto acc = q.template accessor<Feature, 2>();
+
+    batch_results_.resize(states.size());
+    for (int64_t n = 0; n < N; ++n) {
+      for (int i = 0; i < kActionsDim; ++i) {
+        batch_results_[n][i] = static_cast<Result>(acc[n][i]);
+      }
+    }
+    return batch_results_;
+  }
+
   std::vector<torch::Tensor> parameters() {
     std::vector<torch::Tensor> out;
     for (const auto &p : model_.parameters()) {
@@ -102,14 +197,52 @@ class JITNetwork : public torch::nn::Module {
 
   void LoadModel(std::string_view fname, char /**/) {
     model_ = torch::jit::load(std::string(fname));
+    model_.to(torch::CppTypeToScalarType<Feature>::value);
+    BuildInference(warmup_);
   }
 
   static constexpr int ActionsDim() { return kActionsDim; }
   static constexpr int FeaturesDim() { return kFeaturesDim; }
 
  private:
+  // Builds the inference copy and runs it warmup times on a zero state.
+  void BuildInference(int warmup) {
+    if (!inference_) return;
+    torch::NoGradGuard no_grad;
+    auto module = model_.clone();
+    module.eval();
+    if (freeze_) {
+      module = torch::jit::freeze(module);
+      if (optimize_) module = torch::jit::optimize_for_inference(module);
+    }
+    inference_model_ = std::move(module);
+
+    std::fill(input_.template data_ptr<Feature>(),
+              input_.template data_ptr<Feature>() + kFeaturesDim, Feature{0});
+    for (int i = 0; i < warmup; ++i) {
+      inference_model_->forward(inputs_);
+    }
+
+    frozen_params_ = parameters();
+    frozen_versions_.clear();
+    for (const auto &p : frozen_params_) {
+      frozen_versions_.push_back(p._version());
+    }
+  }
+
   torch::jit::script::Module model_;
+  std::optional<torch::jit::script::Module> inference_model_{};
+  bool inference_{false};
+  bool freeze_{true};
+  bool optimize_{true};
+  int warmup_{0};
+  int refresh_warmup_{0};
+  std::vector<torch::Tensor> frozen_params_{};
+  std::vector<int64_t> frozen_versions_{};
+  torch::Tensor input_{};
+  std::vector<torch::jit::IValue> inputs_{};
   ResultsList results_{};
+  std::vector<ResultsList> batch_results_{};
 };
 
 }  // namespace RLlib::Models
@@ -2,6 +2,8 @@
 #define MODELS_TORCH_LINEAR_H
 
 #include <agent.h>
+#include <checkpoint.h>
+#include <kernels.h>
 #include <torch/torch.h>
 
 #include <array>
@@ -10,9 +12,18 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace RLlib::Models {
 
+// Acting (GetActionValues / GetBatchActionValues) on a CPU network with a
+// floating-point Feature skips libtorch entirely: the matvec runs on the
+// weight tensor's storage with the Kernels::MultiDot SIMD kernel, since the
+// dispatch around a from_blob + linear + copy costs far more than a small
+// layer's arithmetic. Training goes through forward() and autograd as
+// before. "native_inference": false forces the torch path, "simd" picks the
+// kernel level as for SimpleLinearModel.
 template <int tFeaturesDim, int tActionsDim, typename TFeature = double,
           typename TResult = double>
 class LinearQNetwork : public torch::nn::Module {
@@ -45,18 +56,22 @@ class LinearQNetwork : public torch::nn::Module {
 
     const auto &w_cfg = config["weights"];
     InitializeWeights(w_cfg);
+
+    native_inference_ = config.value("native_inference", true);
+    if (config.contains("simd") && config["simd"] != "auto") {
+      simd_ = Kernels::NameToSimdLevel(config["simd"].get<std::string>());
+    }
   }
 
   torch::Tensor forward(const torch::Tensor &X) { return linear_->forward(X); }
 
   const ResultsList &GetActionValues(const State &state, bool semigrad = true) {
-    auto dtype = torch::CppTypeToScalarType<TFeature>::value;
     const auto opts = torch::TensorOptions().dtype(
         torch::CppTypeToScalarType<Feature>::value);
 
 #ifdef DEBUG
     const auto W = linear_->weight.detach().to(torch::kCPU);
-    const auto acc = W.accessor<double, 2>();
+    const auto acc = W.template accessor<Feature, 2>();
     for (int i = 0; i < kActionsDim; ++i) {
       for (int j = 0; j < kFeaturesDim; ++j) {
         std::cout << i << "," << j << "," << acc[i][j] << std::endl;
@@ -64,6 +79,11 @@ class LinearQNetwork : public torch::nn::Module {
     }
 #endif
 
+    if (const Feature *w = NativeWeights()) {
+      NativeForward(w, state.data(), results_);
+      return results_;
+    }
+
     auto eval_forward = [&]() {
       auto input =
           torch::from_blob(const_cast<Feature *>(state.data()),
@@ -73,7 +93,7 @@ class LinearQNetwork : public torch::nn::Module {
       auto q = output.squeeze(0);
 
       auto q_cpu = q.to(torch::kCPU);
-      auto q_acc = q_cpu.template accessor<Result, 1>();
+      auto q_acc = q_cpu.template accessor<Feature, 1>();
 
       for (int i = 0; i < kActionsDim; ++i) {
         results_[i] = static_cast<Result>(q_acc[i]);
@@ -90,6 +110,35 @@ class LinearQNetwork : public torch::nn::Module {
     return results_;
   }
 
+  // One [N, kFeaturesDim] forward for N states.
+  const std::vector<ResultsList> &GetBatchActionValues(
+      const std::vector<State> &states) {
+    batch_results_.resize(states.size());
+    if (const Feature *w = NativeWeights()) {
+      for (std::size_t n = 0; n < states.size(); ++n) {
+        NativeForward(w, states[n].data(), batch_results_[n]);
+      }
+      return batch_results_;
+    }
+
+    torch::NoGradGuard no_grad;
+    const auto opts = torch::TensorOptions().dtype(
+        torch::CppTypeToScalarType<Feature>::value);
+    const auto N = static_cast<int64_t>(states.size());
+    auto input = torch::from_blob(const_cast<State *>(states.data()),
+                                  std::array<int64_t, 2>{N, kFeaturesDim},
+                                  opts);
+    auto q = linear_->forward(input).to(torch::kCPU);
+    auto q_acc = q.template accessor<Feature, 2>();
+
+    for (int64_t n = 0; n < N; ++n) {
+      for (int i = 0; i < kActionsDim; ++i) {
+        batch_results_[n][i] = static_cast<Result>(q_acc[n][i]);
+      }
+    }
+    return batch_results_;
+  }
+
   void OutputModel(std::string_view fname, char delimiter = '\n',
                    bool append = false) const {
     std::ofstream ofs(std::string(fname),
@@ -100,7 +149,7 @@ class LinearQNetwork : public torch::nn::Module {
     }
 
     const auto W = linear_->weight.detach().to(torch::kCPU);
-    const auto acc = W.accessor<double, 2>();
+    const auto acc = W.template accessor<Feature, 2>();
 
     for (int i = 0; i < kActionsDim; ++i) {
       for (int j = 0; j < kFeaturesDim; ++j) {
@@ -159,12 +208,74 @@ class LinearQNetwork : public torch::nn::Module {
     }
   }
 
+  void SaveCheckpoint(std::string_view fname) const {
+    const auto W = linear_->weight.detach().to(torch::kCPU).contiguous();
+    Checkpoint::Save(fname, kActionsDim, kFeaturesDim,
+                     W.template data_ptr<Feature>());
+  }
+
+  // Copies straight from the mapped file into the weight tensor.
+  void LoadCheckpoint(std::string_view fname) {
+    Checkpoint::MappedFile file(fname);
+    const Feature *data = file.Data<Feature>(kActionsDim, kFeaturesDim);
+    const auto opts = torch::TensorOptions().dtype(
+        torch::CppTypeToScalarType<Feature>::value);
+    torch::NoGradGuard no_grad;
+    linear_->weight.copy_(torch::from_blob(
+        const_cast<Feature *>(data),
+        std::array<int64_t, 2>{kActionsDim, kFeaturesDim}, opts));
+  }
+
+  // row-major [kActionsDim, kFeaturesDim]; weights that are not a
+  // contiguous CPU tensor are first copied to a host buffer
+  const Feature *ParameterData() const {
+    const auto &W = linear_->weight;
+    if (W.is_cpu() && W.is_contiguous()) {
+      return W.template data_ptr<Feature>();
+    }
+    host_weights_ = W.detach().to(torch::kCPU).contiguous();
+    return host_weights_.template data_ptr<Feature>();
+  }
+
   static constexpr int ActionsDim() { return kActionsDim; }
   static constexpr int FeaturesDim() { return kFeaturesDim; }
 
   using ModuleType = LinearQNetwork;
 
+  // Whether acting currently takes the native path.
+  bool NativeInference() { return NativeWeights() != nullptr; }
+
  private:
+  // below a couple of vector widths the call overhead outweighs SIMD
+  static Kernels::SimdLevel AutoSimdLevel() {
+    return kFeaturesDim < 8 ? Kernels::SimdLevel::kScalar
+                            : Kernels::DetectedSimdLevel();
+  }
+
+  // The row-major [kActionsDim, kFeaturesDim] weights if the native path
+  // can read them, null otherwise.
+  const Feature *NativeWeights() {
+    if constexpr (std::is_floating_point_v<Feature>) {
+      const auto &W = linear_->weight;
+      if (native_inference_ && W.is_cpu() && W.is_contiguous() &&
+          W.scalar_type() == torch::CppTypeToScalarType<Feature>::value) {
+        return W.template data_ptr<Feature>();
+      }
+    }
+    return nullptr;
+  }
+
+  void NativeForward(const Feature *w, const Feature *x, ResultsList &out) {
+    if constexpr (std::is_floating_point_v<Feature>) {
+      std::array<Feature, kActionsDim> values;
+      Kernels::MultiDot<kActionsDim>(simd_, w, kFeaturesDim, x, kFeaturesDim,
+                                     values.data());
+      for (int i = 0; i < kActionsDim; ++i) {
+        out[i] = static_cast<Result>(values[i]);
+      }
+    }
+  }
+
   void InitializeWeights(const json &w_cfg) {
     const auto opts = torch::TensorOptions().dtype(
         torch::CppTypeToScalarType<Feature>::value);
@@ -220,7 +331,11 @@ class LinearQNetwork : public torch::nn::Module {
 
   torch::nn::Linear linear_{nullptr};
   ResultsList results_{};
+  std::vector<ResultsList> batch_results_{};
   bool debug_output_{};
+  bool native_inference_{true};
+  Kernels::SimdLevel simd_{AutoSimdLevel()};
+  mutable torch::Tensor host_weights_{};
 };
 
 }  // namespace RLlib::Models
@@ -1,38 +1,299 @@
 #pragma once
 
-#include <random>
+#include <atomic>
 #include <chrono>
-#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
 
+// Random numbers for the acting and learning hot paths.
+//
+// Every thread owns an independent xoshiro256++ stream derived from one
+// global seed: stream k is the seeded generator advanced by k jumps of 2^128
+// draws, so streams never overlap. seed() makes a run reproducible; threads
+// that need a fixed stream regardless of start-up order call set_stream().
+// Philox4x32 is a counter-based alternative whose output for (seed, stream,
+// counter) is a pure function, handy when work is redistributed across
+// threads. Both satisfy UniformRandomBitGenerator.
 namespace rng_util {
 
-inline std::mt19937_64 &engine() {
-    thread_local std::mt19937_64 eng([]() {
+inline uint64_t splitmix64(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+class Xoshiro256PlusPlus {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256PlusPlus(uint64_t seed = 0) {
+        for (auto &s : s_) s = splitmix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s_[0] + s_[3], 23) + s_[0];
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // Equivalent to 2^128 calls of operator(); used to split streams.
+    void jump() {
+        constexpr uint64_t kJump[] = {0x180ec6d33cfd0abaull,
+                                      0xd5a61266f0c9392cull,
+                                      0xa9582618e03fc9aaull,
+                                      0x39abdc4529b1661cull};
+        uint64_t t[4] = {0, 0, 0, 0};
+        for (uint64_t word : kJump) {
+            for (int b = 0; b < 64; ++b) {
+                if (word & (uint64_t{1} << b)) {
+                    for (int i = 0; i < 4; ++i) t[i] ^= s_[i];
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; ++i) s_[i] = t[i];
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t s_[4];
+};
+
+// Philox4x32-10 (Salmon et al., SC'11). The 128-bit counter is split into a
+// block index (low half) and a stream id (high half); each block yields two
+// 64-bit outputs.
+class Philox4x32 {
+public:
+    using result_type = uint64_t;
+
+    explicit Philox4x32(uint64_t seed = 0, uint64_t stream = 0)
+        : key_{static_cast<uint32_t>(seed),
+               static_cast<uint32_t>(seed >> 32)},
+          stream_(stream) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        if (pos_ == 2) {
+            block(block_++, out_);
+            pos_ = 0;
+        }
+        return out_[pos_++];
+    }
+
+    // Random access: the two outputs of block `index` of this stream.
+    void block(uint64_t index, uint64_t out[2]) const {
+        uint32_t ctr[4] = {static_cast<uint32_t>(index),
+                           static_cast<uint32_t>(index >> 32),
+                           static_cast<uint32_t>(stream_),
+                           static_cast<uint32_t>(stream_ >> 32)};
+        uint32_t r[4];
+        rounds(ctr, key_, r);
+        out[0] = (static_cast<uint64_t>(r[1]) << 32) | r[0];
+        out[1] = (static_cast<uint64_t>(r[3]) << 32) | r[2];
+    }
+
+    void seek(uint64_t block_index) {
+        block_ = block_index;
+        pos_ = 2;
+    }
+
+    // The raw Philox4x32-10 bijection.
+    static void rounds(const uint32_t in[4], const uint32_t key[2],
+                       uint32_t out[4]) {
+        constexpr uint32_t kM0 = 0xD2511F53u, kM1 = 0xCD9E8D57u;
+        constexpr uint32_t kW0 = 0x9E3779B9u, kW1 = 0xBB67AE85u;
+        uint32_t c0 = in[0], c1 = in[1], c2 = in[2], c3 = in[3];
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int i = 0; i < 10; ++i) {
+            const uint64_t p0 = static_cast<uint64_t>(kM0) * c0;
+            const uint64_t p1 = static_cast<uint64_t>(kM1) * c2;
+            const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<uint32_t>(p1);
+            c3 = static_cast<uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += kW0;
+            k1 += kW1;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+private:
+    uint32_t key_[2];
+    uint64_t stream_;
+    uint64_t block_{0};
+    uint64_t out_[2]{};
+    int pos_{2};
+};
+
+// Top 53 bits as a double in [0, 1).
+inline double to_unit(uint64_t x) {
+    return static_cast<double>(x >> 11) * 0x1.0p-53;
+}
+
+// Unbiased integer in [0, n) (Lemire's multiply-shift with rejection).
+template <typename TRng>
+uint64_t uniform_int(TRng &rng, uint64_t n) {
+    unsigned __int128 m = static_cast<unsigned __int128>(rng()) * n;
+    uint64_t low = static_cast<uint64_t>(m);
+    if (low < n) {
+        const uint64_t threshold = -n % n;
+        while (low < threshold) {
+            m = static_cast<unsigned __int128>(rng()) * n;
+            low = static_cast<uint64_t>(m);
+        }
+    }
+    return static_cast<uint64_t>(m >> 64);
+}
+
+template <typename TRng>
+void fill_uniform(TRng &rng, double *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) out[i] = to_unit(rng());
+}
+
+// Box-Muller on pairs of uniforms; n need not be even.
+template <typename TRng>
+void fill_normal(TRng &rng, double *out, std::size_t n, double mean = 0.0,
+                 double stddev = 1.0) {
+    constexpr double kTwoPi = 6.283185307179586;
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        // 1 - u keeps the log argument in (0, 1]
+        const double r = std::sqrt(-2.0 * std::log(1.0 - to_unit(rng())));
+        const double theta = kTwoPi * to_unit(rng());
+        out[i] = mean + stddev * r * std::cos(theta);
+        out[i + 1] = mean + stddev * r * std::sin(theta);
+    }
+    if (i < n) {
+        const double r = std::sqrt(-2.0 * std::log(1.0 - to_unit(rng())));
+        out[i] = mean + stddev * r * std::cos(kTwoPi * to_unit(rng()));
+    }
+}
+
+namespace detail {
+
+struct SeedState {
+    std::atomic<uint64_t> seed;
+    std::atomic<uint64_t> next_stream{0};
+};
+
+inline SeedState &seed_state() {
+    static SeedState state{[]() {
         std::random_device rd;
-        auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-        std::array<uint32_t, 4> seed_data{
-            static_cast<uint32_t>(rd()),
-            static_cast<uint32_t>(rd()),
-            static_cast<uint32_t>(now & 0xffffffffu),
-            static_cast<uint32_t>((now >> 32) & 0xffffffffu)
-        };
-        std::seed_seq seq(seed_data.begin(), seed_data.end());
-        std::mt19937_64 e;
-        e.seed(seq);
-        return e;
-    }());
+        using Clock = std::chrono::high_resolution_clock;
+        auto now =
+            static_cast<uint64_t>(Clock::now().time_since_epoch().count());
+        uint64_t mix = (static_cast<uint64_t>(rd()) << 32) ^ rd() ^ now;
+        return splitmix64(mix);
+    }()};
+    return state;
+}
+
+struct ThreadState {
+    Xoshiro256PlusPlus engine;
+    double spare_normal{0.0};
+    bool has_spare{false};
+};
+
+}  // namespace detail
+
+// Stream `stream` of the current global seed.
+inline Xoshiro256PlusPlus make_stream(uint64_t stream) {
+    Xoshiro256PlusPlus eng(
+        detail::seed_state().seed.load(std::memory_order_relaxed));
+    for (uint64_t i = 0; i < stream; ++i) eng.jump();
     return eng;
 }
 
-inline double uniform01() {
-    thread_local std::uniform_real_distribution<double> dist(0.0, std::nextafter(1.0, 2.0));
-    return dist(engine());
+// The next unused stream of the current global seed.
+inline Xoshiro256PlusPlus new_stream() {
+    auto &state = detail::seed_state();
+    return make_stream(
+        state.next_stream.fetch_add(1, std::memory_order_relaxed));
+}
+
+namespace detail {
+
+inline ThreadState &thread_state() {
+    thread_local ThreadState state{new_stream()};
+    return state;
+}
+
+}  // namespace detail
+
+inline Xoshiro256PlusPlus &engine() { return detail::thread_state().engine; }
+
+// Pins the calling thread to stream `stream` of the global seed.
+inline void set_stream(uint64_t stream) {
+    auto &state = detail::thread_state();
+    state.engine = make_stream(stream);
+    state.has_spare = false;
 }
 
+// Sets the global seed and moves the calling thread to stream 0; later
+// new_stream() calls and threads drawing for the first time continue from
+// stream 1. Call before spawning workers.
+inline void seed(uint64_t value) {
+    detail::thread_state();  // claim this thread's stream under the old seed
+    auto &state = detail::seed_state();
+    state.seed.store(value, std::memory_order_relaxed);
+    state.next_stream.store(1, std::memory_order_relaxed);
+    set_stream(0);
+}
+
+// Keeps streams [1, count] for set_stream(): new_stream() and threads
+// drawing for the first time continue from stream count + 1, so they never
+// share a stream with a pinned thread. Call after seed().
+inline void reserve_streams(uint64_t count) {
+    auto &next = detail::seed_state().next_stream;
+    uint64_t current = next.load(std::memory_order_relaxed);
+    while (current <= count &&
+           !next.compare_exchange_weak(current, count + 1,
+                                       std::memory_order_relaxed)) {
+    }
+}
+
+inline double uniform01() { return to_unit(engine()()); }
+
+inline uint64_t uniform_int(uint64_t n) { return uniform_int(engine(), n); }
 
 inline double normal(double mean = 0.0, double stddev = 1.0) {
-    std::normal_distribution<double> dist(mean, stddev);
-    return dist(engine());
+    auto &state = detail::thread_state();
+    if (state.has_spare) {
+        state.has_spare = false;
+        return mean + stddev * state.spare_normal;
+    }
+    double pair[2];
+    fill_normal(state.engine, pair, 2);
+    state.spare_normal = pair[1];
+    state.has_spare = true;
+    return mean + stddev * pair[0];
 }
 
 } // namespace rng_util
@@ -0,0 +1,233 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <extern/tinyexpr.h>
+
+#include <algorithm>
+#include <cmath>
+#include <extern/json.hpp>
+#include <memory>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace RLlib {
+
+enum class ScheduleType {
+  kNone = 0,
+  kTable = 1,
+  kFormula = 2,
+  kConstant = 3,
+  kInverseTime = 4,
+  kExponential = 5,
+  kPiecewise = 6,
+  kCosine = 7,
+  kTypesCount = 8
+};
+
+constexpr const char *ScheduleTypeNames[] = {
+    "none",        "table",     "formula", "constant", "inverse_time",
+    "exponential", "piecewise", "cosine"};
+
+inline ScheduleType NameToScheduleType(std::string_view name) {
+  for (int i = 0; i < static_cast<int>(ScheduleType::kTypesCount); ++i) {
+    if (name == ScheduleTypeNames[i]) {
+      return static_cast<ScheduleType>(i);
+    }
+  }
+  throw std::runtime_error("Invalid schedule type: " + std::string(name));
+}
+
+// Maps the round counter to a value (typically a learning rate). All parsing
+// and formula compilation happens at construction; Value() does not allocate.
+//
+// Accepted JSON forms:
+//   [0.1, 0.05, ...]                 table indexed by round, last entry held
+//   "0.1 / (round + 1)"              tinyexpr formula in the variable `round`
+//   {"type": "constant", "value": v}
+//   {"type": "inverse_time", "initial": a, "decay": k, "minimum": m}
+//       a / (1 + k * round) + m
+//   {"type": "exponential", "initial": a, "rate": r, "minimum": m}
+//       max(a * r^round, m)
+//   {"type": "piecewise", "boundaries": [b0, ...], "values": [v0, v1, ...]}
+//       v_i for b_{i-1} <= round < b_i
+//   {"type": "cosine", "initial": a, "minimum": m, "period": T}
+//       m + (a - m) * (1 + cos(pi * min(round, T) / T)) / 2
+class Schedule {
+ public:
+  Schedule() = default;
+
+  explicit Schedule(const json &config) {
+    if (config.is_array()) {
+      type_ = ScheduleType::kTable;
+      values_ = config.get<std::vector<double>>();
+      if (values_.empty()) {
+        type_ = ScheduleType::kNone;
+      }
+    } else if (config.is_string()) {
+      type_ = ScheduleType::kFormula;
+      CompileFormula(config.get<std::string>());
+    } else if (config.is_number()) {
+      type_ = ScheduleType::kConstant;
+      initial_ = config.get<double>();
+    } else if (config.is_object()) {
+      if (!config.contains("type") || !config["type"].is_string()) {
+        throw std::runtime_error("Schedule object requires a 'type' string");
+      }
+      type_ = NameToScheduleType(config["type"].get<std::string>());
+      switch (type_) {
+        case ScheduleType::kTable:
+          values_ = config.at("values").get<std::vector<double>>();
+          if (values_.empty()) {
+            throw std::runtime_error("Table schedule requires values");
+          }
+          break;
+        case ScheduleType::kFormula:
+          CompileFormula(config.at("formula").get<std::string>());
+          break;
+        case ScheduleType::kConstant:
+          initial_ = config.at("value").get<double>();
+          break;
+        case ScheduleType::kInverseTime:
+          initial_ = config.at("initial").get<double>();
+          rate_ = config.value("decay", 1.0);
+          minimum_ = config.value("minimum", 0.0);
+          break;
+        case ScheduleType::kExponential:
+          initial_ = config.at("initial").get<double>();
+          rate_ = config.at("rate").get<double>();
+          minimum_ = config.value("minimum", 0.0);
+          if (rate_ <= 0.0) {
+            throw std::runtime_error("Exponential schedule rate must be > 0");
+          }
+          log_rate_ = std::log(rate_);
+          break;
+        case ScheduleType::kPiecewise:
+          boundaries_ = config.at("boundaries").get<std::vector<double>>();
+          values_ = config.at("values").get<std::vector<double>>();
+          if (values_.size() != boundaries_.size() + 1) {
+            throw std::runtime_error(
+                "Piecewise schedule requires len(values) == "
+                "len(boundaries) + 1");
+          }
+          if (!std::is_sorted(boundaries_.begin(), boundaries_.end())) {
+            throw std::runtime_error(
+                "Piecewise schedule boundaries must be ascending");
+          }
+          break;
+        case ScheduleType::kCosine:
+          initial_ = config.at("initial").get<double>();
+          minimum_ = config.value("minimum", 0.0);
+          period_ = config.at("period").get<double>();
+          if (period_ <= 0.0) {
+            throw std::runtime_error("Cosine schedule period must be > 0");
+          }
+          break;
+        default:
+          throw std::runtime_error("Unsupported schedule type");
+      }
+    } else {
+      throw std::runtime_error("Invalid schedule format in config JSON");
+    }
+  }
+
+  explicit Schedule(const std::vector<double> &values)
+      : type_(values.empty() ? ScheduleType::kNone : ScheduleType::kTable),
+        values_(values) {}
+
+  Schedule(const Schedule &other) { *this = other; }
+  Schedule(Schedule &&other) noexcept = default;
+
+  Schedule &operator=(const Schedule &other) {
+    if (this == &other) return *this;
+    type_ = other.type_;
+    values_ = other.values_;
+    boundaries_ = other.boundaries_;
+    initial_ = other.initial_;
+    rate_ = other.rate_;
+    log_rate_ = other.log_rate_;
+    minimum_ = other.minimum_;
+    period_ = other.period_;
+    expr_.reset();
+    round_var_.reset();
+    formula_.clear();
+    if (type_ == ScheduleType::kFormula) {
+      CompileFormula(other.formula_);
+    }
+    return *this;
+  }
+  Schedule &operator=(Schedule &&other) noexcept = default;
+
+  bool Empty() const { return type_ == ScheduleType::kNone; }
+
+  ScheduleType Type() const { return type_; }
+
+  const std::string &Formula() const { return formula_; }
+
+  double Value(int round) const {
+    switch (type_) {
+      case ScheduleType::kTable:
+        return values_[std::min(static_cast<size_t>(round),
+                                values_.size() - 1)];
+      case ScheduleType::kFormula:
+        *round_var_ = static_cast<double>(round);
+        return te_eval(expr_.get());
+      case ScheduleType::kConstant:
+        return initial_;
+      case ScheduleType::kInverseTime:
+        return initial_ / (1.0 + rate_ * round) + minimum_;
+      case ScheduleType::kExponential:
+        return std::max(initial_ * std::exp(log_rate_ * round), minimum_);
+      case ScheduleType::kPiecewise:
+        return values_[std::upper_bound(boundaries_.begin(),
+                                        boundaries_.end(),
+                                        static_cast<double>(round)) -
+                       boundaries_.begin()];
+      case ScheduleType::kCosine: {
+        double t = std::min(static_cast<double>(round), period_) / period_;
+        return minimum_ + 0.5 * (initial_ - minimum_) *
+                              (1.0 + std::cos(std::numbers::pi * t));
+      }
+      default:
+        throw std::runtime_error("Evaluating an empty schedule");
+    }
+  }
+
+ private:
+  struct ExprDeleter {
+    void operator()(te_expr *expr) const { te_free(expr); }
+  };
+
+  void CompileFormula(const std::string &formula) {
+    formula_ = formula;
+    // the bound variable lives on the heap so moves keep the address valid
+    round_var_ = std::make_unique<double>(0.0);
+    te_variable vars[] = {{"round", round_var_.get()}};
+    int err;
+    expr_.reset(te_compile(formula_.c_str(), vars, 1, &err));
+    if (!expr_) {
+      throw std::runtime_error(
+          "Failed to parse schedule formula at position " +
+          std::to_string(err));
+    }
+  }
+
+  ScheduleType type_{ScheduleType::kNone};
+  std::vector<double> values_{};
+  std::vector<double> boundaries_{};
+  double initial_{};
+  double rate_{};
+  double log_rate_{};
+  double minimum_{};
+  double period_{1.0};
+  std::string formula_{};
+  std::unique_ptr<double> round_var_{};
+  std::unique_ptr<te_expr, ExprDeleter> expr_{};
+};
+
+}  // namespace RLlib
+#endif  // SCHEDULE_H
@@ -0,0 +1,165 @@
+#ifndef SNAPSHOT_WRITER_H
+#define SNAPSHOT_WRITER_H
+
+#include <checkpoint.h>
+#include <concurrency.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <extern/json.hpp>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Periodic model snapshots written off the training thread.
+//
+// Stream layout: a Checkpoint::Header carrying kSnapshotMagic, with
+// payload_bytes set to the size of one record's parameters, followed by
+// records of {uint64 step, rows * cols elements}. The training thread copies
+// parameters into a preallocated slot and hands it to a writer thread over a
+// bounded SPSC queue; when every slot is in flight Push() waits for the
+// writer instead of dropping snapshots.
+namespace RLlib {
+
+constexpr char kSnapshotMagic[8] = {'R', 'L', 'S', 'N', 'A', 'P', '\0', '\0'};
+
+template <typename T>
+class SnapshotWriter {
+ public:
+  // config keys: "file" (required), "every" (steps between snapshots,
+  // default 1000), "queue_capacity" (in-flight snapshots, default 16)
+  SnapshotWriter(const json &config, std::uint64_t rows, std::uint64_t cols)
+      : every_(config.value("every", std::uint64_t{1000})),
+        elems_(rows * cols),
+        slots_(config.value("queue_capacity", std::size_t{16})),
+        filled_(slots_),
+        free_(slots_) {
+    if (every_ == 0) {
+      throw std::runtime_error("snapshot every must be > 0");
+    }
+    const auto fname = config.at("file").get<std::string>();
+    buffer_.resize(kStreamBufferSize);
+    ofs_.rdbuf()->pubsetbuf(buffer_.data(),
+                            static_cast<std::streamsize>(buffer_.size()));
+    ofs_.open(fname, std::ios::binary | std::ios::trunc);
+    if (!ofs_.is_open()) {
+      throw std::runtime_error("Failed to open snapshot file: " + fname);
+    }
+    Checkpoint::Header header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = Checkpoint::kVersion;
+    header.dtype = static_cast<std::uint32_t>(Checkpoint::DTypeOf<T>());
+    header.rows = rows;
+    header.cols = cols;
+    header.payload_bytes = elems_ * sizeof(T);
+    ofs_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    data_.resize(slots_ * elems_);
+    steps_.resize(slots_);
+    for (std::size_t slot = 0; slot < slots_; ++slot) free_.TryPush(slot);
+    thread_ = std::thread([this] { Run(); });
+  }
+
+  SnapshotWriter(const SnapshotWriter &) = delete;
+  SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+  ~SnapshotWriter() {
+    stop_.store(true, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+  }
+
+  bool Due(std::uint64_t step) const { return step % every_ == 0; }
+
+  // Copies rows * cols elements from data; call from a single thread.
+  void Push(std::uint64_t step, const T *data) {
+    std::size_t slot;
+    while (!free_.TryPop(slot)) std::this_thread::yield();
+    std::memcpy(data_.data() + slot * elems_, data, elems_ * sizeof(T));
+    steps_[slot] = step;
+    filled_.TryPush(slot);
+  }
+
+  std::uint64_t Written() const {
+    return written_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr std::size_t kStreamBufferSize = 1 << 20;
+
+  void Run() {
+    std::size_t slot;
+    for (;;) {
+      // read the flag first: everything pushed before it was set is then
+      // visible to the TryPop below
+      const bool stopping = stop_.load(std::memory_order_acquire);
+      if (filled_.TryPop(slot)) {
+        ofs_.write(reinterpret_cast<const char *>(&steps_[slot]),
+                   sizeof(std::uint64_t));
+        ofs_.write(reinterpret_cast<const char *>(data_.data() + slot * elems_),
+                   static_cast<std::streamsize>(elems_ * sizeof(T)));
+        free_.TryPush(slot);
+        written_.fetch_add(1, std::memory_order_relaxed);
+      } else if (stopping) {
+        break;
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+    }
+    ofs_.flush();
+  }
+
+  std::uint64_t every_;
+  std::size_t elems_;
+  std::size_t slots_;
+  std::vector<T> data_;
+  std::vector<std::uint64_t> steps_;
+  SpscQueue<std::size_t> filled_;
+  SpscQueue<std::size_t> free_;
+  std::vector<char> buffer_;
+  std::ofstream ofs_;
+  std::atomic<bool> stop_{false};
+  std::atomic<std::uint64_t> written_{0};
+  std::thread thread_;
+};
+
+// Reads a snapshot stream back, calling fn(step, parameters) for every
+// record; returns the stream header.
+template <typename T>
+Checkpoint::Header ReadSnapshots(
+    std::string_view fname,
+    const std::function<void(std::uint64_t, std::span<const T>)> &fn) {
+  std::ifstream ifs(std::string(fname), std::ios::binary);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("Failed to open snapshot file: " +
+                             std::string(fname));
+  }
+  Checkpoint::Header header{};
+  ifs.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!ifs || std::memcmp(header.magic, kSnapshotMagic,
+                          sizeof(kSnapshotMagic)) != 0) {
+    throw std::runtime_error("Not a snapshot file: " + std::string(fname));
+  }
+  if (header.dtype != static_cast<std::uint32_t>(Checkpoint::DTypeOf<T>())) {
+    throw std::runtime_error("Snapshot dtype mismatch: " + std::string(fname));
+  }
+  std::vector<T> record(header.rows * header.cols);
+  std::uint64_t step;
+  while (ifs.read(reinterpret_cast<char *>(&step), sizeof(step)) &&
+         ifs.read(reinterpret_cast<char *>(record.data()),
+                  static_cast<std::streamsize>(header.payload_bytes))) {
+    fn(step, std::span<const T>(record));
+  }
+  return header;
+}
+
+}  // namespace RLlib
+
+#endif  // SNAPSHOT_WRITER_H
@@ -1,5 +1,7 @@
 #ifndef TABULAR_AGENT_H
 #define TABULAR_AGENT_H
+#include <models/hogwild.h>
+#include <models/sparse_tabular.h>
 #include <models/tabular.h>
 
 #include "agents/sarsa.h"
@@ -9,5 +11,18 @@ template <int tStatesDim, int tActionsDim, typename TAction = int,
           typename TReward = double>
 using TabularSarsaAgent =
     SarsaAgent<Models::Tabular<tStatesDim, tActionsDim>, TAction, TReward>;
+
+// For state spaces too large for a dense table; states are integer ids.
+template <int tActionsDim, typename TAction = int, typename TReward = double,
+          typename TState = std::uint64_t>
+using SparseTabularSarsaAgent =
+    SarsaAgent<Models::SparseTabular<tActionsDim, TState>, TAction, TReward>;
+
+// Agents built from copies of one model share its table (Hogwild training).
+template <int tStatesDim, int tActionsDim, typename TAction = int,
+          typename TReward = double>
+using HogwildTabularSarsaAgent =
+    SarsaAgent<Models::HogwildTabular<tStatesDim, tActionsDim>, TAction,
+               TReward>;
 }  // namespace RLlib
 #endif
\ No newline at end of file
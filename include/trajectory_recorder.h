@@ -0,0 +1,277 @@
+#ifndef TRAJECTORY_RECORDER_H
+#define TRAJECTORY_RECORDER_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <extern/json.hpp>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Streams the (reward, state) sequence of a run to disk in fixed-size chunks
+// so memory stays constant however many steps are recorded.
+//
+// Layout: a TrajectoryHeader, then chunks of {uint32 steps, uint32 bytes}
+// followed by `bytes` of payload. A raw payload is steps float64 rewards and
+// steps * state_width int32 state entries. A delta payload stores each state
+// entry as a zigzag LEB128 varint of its change from the previous step and
+// each reward as a varint of its bit pattern XOR the previous reward, byte
+// swapped so that the sign/exponent/leading mantissa bytes, where rewards
+// differ, become the low bytes. A repeated reward costs one byte and short
+// binary fractions such as 0.25 or -1.5 two or three. Deltas restart at
+// every chunk, so chunks decode independently.
+namespace RLlib {
+
+enum class TrajectoryEncoding : std::uint32_t {
+  kRaw = 0,
+  kDelta = 1,
+  kEncodingsCount = 2
+};
+
+constexpr const char *TrajectoryEncodingNames[] = {"raw", "delta"};
+
+inline TrajectoryEncoding NameToTrajectoryEncoding(std::string_view name) {
+  for (int i = 0; i < static_cast<int>(TrajectoryEncoding::kEncodingsCount);
+       ++i) {
+    if (name == TrajectoryEncodingNames[i]) {
+      return static_cast<TrajectoryEncoding>(i);
+    }
+  }
+  throw std::runtime_error("Invalid TrajectoryEncoding name");
+}
+
+constexpr char kTrajectoryMagic[8] = {'R', 'L', 'T', 'R', 'A', 'J', '\0', '\0'};
+
+struct TrajectoryHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t state_width;
+  std::uint32_t encoding;
+  std::uint32_t chunk_steps;
+};
+
+namespace detail {
+
+inline void PutVarint(std::vector<std::uint8_t> &out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<std::uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(v));
+}
+
+inline std::uint64_t GetVarint(const std::uint8_t *&p,
+                               const std::uint8_t *end) {
+  std::uint64_t v = 0;
+  for (int shift = 0; p < end && shift < 64; shift += 7) {
+    const std::uint8_t byte = *p++;
+    v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return v;
+  }
+  throw std::runtime_error("Corrupt trajectory chunk");
+}
+
+inline std::uint64_t ZigZag(std::int64_t v) {
+  return (static_cast<std::uint64_t>(v) << 1) ^
+         static_cast<std::uint64_t>(v >> 63);
+}
+
+inline std::int64_t UnZigZag(std::uint64_t v) {
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+}  // namespace detail
+
+class TrajectoryRecorder {
+ public:
+  static constexpr std::uint32_t kVersion = 1;
+
+  // config keys: "file" (default trajectory.bin), "chunk_steps" (default
+  // 65536), "encoding" ("raw" or "delta", default delta)
+  TrajectoryRecorder(const json &config, std::uint32_t state_width)
+      : state_width_(state_width),
+        encoding_(NameToTrajectoryEncoding(config.value("encoding", "delta"))),
+        chunk_steps_(config.value("chunk_steps", std::uint32_t{65536})) {
+    if (chunk_steps_ == 0) {
+      throw std::runtime_error("chunk_steps must be > 0");
+    }
+    const auto fname = config.value("file", std::string{"trajectory.bin"});
+    ofs_.open(fname, std::ios::binary | std::ios::trunc);
+    if (!ofs_.is_open()) {
+      throw std::runtime_error("Failed to open trajectory file: " + fname);
+    }
+    TrajectoryHeader header{};
+    std::memcpy(header.magic, kTrajectoryMagic, sizeof(kTrajectoryMagic));
+    header.version = kVersion;
+    header.state_width = state_width_;
+    header.encoding = static_cast<std::uint32_t>(encoding_);
+    header.chunk_steps = chunk_steps_;
+    ofs_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    rewards_.reserve(chunk_steps_);
+    states_.reserve(static_cast<std::size_t>(chunk_steps_) * state_width_);
+  }
+
+  TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+  TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+
+  // destructors must not throw; call Flush() first to see write errors
+  ~TrajectoryRecorder() {
+    try {
+      Flush();
+    } catch (const std::exception &) {
+    }
+  }
+
+  void Record(double reward, std::span<const std::int32_t> state) {
+    if (state.size() != state_width_) {
+      throw std::runtime_error("Trajectory state width mismatch");
+    }
+    rewards_.push_back(reward);
+    states_.insert(states_.end(), state.begin(), state.end());
+    if (rewards_.size() == chunk_steps_) Flush();
+  }
+
+  void Record(double reward, std::initializer_list<std::int32_t> state) {
+    Record(reward, std::span<const std::int32_t>(state.begin(), state.size()));
+  }
+
+  // Writes the pending partial chunk.
+  void Flush() {
+    if (rewards_.empty()) return;
+    const auto steps = static_cast<std::uint32_t>(rewards_.size());
+    if (encoding_ == TrajectoryEncoding::kRaw) {
+      WriteChunk(steps, rewards_.data(), rewards_.size() * sizeof(double),
+                 states_.data(), states_.size() * sizeof(std::int32_t));
+    } else {
+      Encode();
+      WriteChunk(steps, encoded_.data(), encoded_.size(), nullptr, 0);
+    }
+    recorded_ += steps;
+    rewards_.clear();
+    states_.clear();
+    ofs_.flush();
+  }
+
+  std::uint64_t Steps() const { return recorded_ + rewards_.size(); }
+
+ private:
+  void WriteChunk(std::uint32_t steps, const void *a, std::size_t a_bytes,
+                  const void *b, std::size_t b_bytes) {
+    const std::uint32_t chunk[2] = {
+        steps, static_cast<std::uint32_t>(a_bytes + b_bytes)};
+    ofs_.write(reinterpret_cast<const char *>(chunk), sizeof(chunk));
+    ofs_.write(static_cast<const char *>(a),
+               static_cast<std::streamsize>(a_bytes));
+    if (b_bytes) {
+      ofs_.write(static_cast<const char *>(b),
+                 static_cast<std::streamsize>(b_bytes));
+    }
+    if (!ofs_) {
+      throw std::runtime_error("Error writing trajectory chunk");
+    }
+  }
+
+  void Encode() {
+    encoded_.clear();
+    std::uint64_t prev_bits = 0;
+    for (double r : rewards_) {
+      const auto bits = std::bit_cast<std::uint64_t>(r);
+      detail::PutVarint(encoded_, __builtin_bswap64(bits ^ prev_bits));
+      prev_bits = bits;
+    }
+    prev_state_.assign(state_width_, 0);
+    for (std::size_t i = 0; i < states_.size(); ++i) {
+      const std::size_t col = i % state_width_;
+      detail::PutVarint(encoded_,
+                        detail::ZigZag(static_cast<std::int64_t>(states_[i]) -
+                                       prev_state_[col]));
+      prev_state_[col] = states_[i];
+    }
+  }
+
+  std::uint32_t state_width_;
+  TrajectoryEncoding encoding_;
+  std::uint32_t chunk_steps_;
+  std::uint64_t recorded_{0};
+  std::vector<double> rewards_;
+  std::vector<std::int32_t> states_;
+  std::vector<std::int64_t> prev_state_;
+  std::vector<std::uint8_t> encoded_;
+  std::ofstream ofs_;
+};
+
+// Reads a trajectory back, calling fn(reward, state) for every step; returns
+// the file header.
+inline TrajectoryHeader ReadTrajectory(
+    std::string_view fname,
+    const std::function<void(double, std::span<const std::int32_t>)> &fn) {
+  const std::string path(fname);
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("Failed to open trajectory file: " + path);
+  }
+  TrajectoryHeader header{};
+  ifs.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!ifs ||
+      std::memcmp(header.magic, kTrajectoryMagic, sizeof(kTrajectoryMagic)) !=
+          0 ||
+      header.version != TrajectoryRecorder::kVersion) {
+    throw std::runtime_error("Not a trajectory file: " + path);
+  }
+  const std::size_t width = header.state_width;
+  std::vector<std::uint8_t> payload;
+  std::vector<double> rewards;
+  std::vector<std::int32_t> states;
+  std::uint32_t chunk[2];
+  while (ifs.read(reinterpret_cast<char *>(chunk), sizeof(chunk))) {
+    const std::uint32_t steps = chunk[0];
+    payload.resize(chunk[1]);
+    if (!ifs.read(reinterpret_cast<char *>(payload.data()), chunk[1])) {
+      throw std::runtime_error("Truncated trajectory file: " + path);
+    }
+    rewards.resize(steps);
+    states.resize(steps * width);
+    if (header.encoding ==
+        static_cast<std::uint32_t>(TrajectoryEncoding::kRaw)) {
+      if (payload.size() !=
+          steps * (sizeof(double) + width * sizeof(std::int32_t))) {
+        throw std::runtime_error("Corrupt trajectory chunk: " + path);
+      }
+      std::memcpy(rewards.data(), payload.data(), steps * sizeof(double));
+      std::memcpy(states.data(), payload.data() + steps * sizeof(double),
+                  states.size() * sizeof(std::int32_t));
+    } else {
+      const std::uint8_t *p = payload.data();
+      const std::uint8_t *end = p + payload.size();
+      std::uint64_t prev_bits = 0;
+      for (auto &r : rewards) {
+        prev_bits ^= __builtin_bswap64(detail::GetVarint(p, end));
+        r = std::bit_cast<double>(prev_bits);
+      }
+      std::vector<std::int64_t> prev(width, 0);
+      for (std::size_t i = 0; i < states.size(); ++i) {
+        auto &last = prev[i % width];
+        last += detail::UnZigZag(detail::GetVarint(p, end));
+        states[i] = static_cast<std::int32_t>(last);
+      }
+    }
+    for (std::uint32_t s = 0; s < steps; ++s) {
+      fn(rewards[s], std::span<const std::int32_t>(states.data() + s * width,
+                                                   width));
+    }
+  }
+  return header;
+}
+
+}  // namespace RLlib
+
+#endif  // TRAJECTORY_RECORDER_H
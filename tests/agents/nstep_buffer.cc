@@ -0,0 +1,64 @@
+#include <agents/nstep_buffer.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <deque>
+#include <random>
+
+using Buffer = RLlib::NStepBuffer<int>;
+
+namespace {
+
+double BruteForceReturn(const std::deque<double> &rewards, double gamma) {
+  double sum = 0.0;
+  for (std::size_t k = 0; k < rewards.size(); ++k) {
+    sum += std::pow(gamma, static_cast<double>(k)) * rewards[k];
+  }
+  return sum;
+}
+
+}  // namespace
+
+TEST(NStepBuffer, ReturnMatchesBruteForce) {
+  std::mt19937_64 rng(3);
+  std::uniform_real_distribution<double> reward(-2.0, 2.0);
+  for (std::size_t n : {1u, 3u, 7u}) {
+    for (double gamma : {0.0, 0.5, 0.99}) {
+      Buffer buffer;
+      buffer.Reset(n, gamma);
+      std::deque<double> window;
+      for (int t = 0; t < 200; ++t) {
+        if (!buffer.Empty()) {
+          const double r = reward(rng);
+          buffer.AddReward(r);
+          window.push_back(r);
+          ASSERT_NEAR(buffer.Return(), BruteForceReturn(window, gamma), 1e-12);
+        }
+        if (buffer.Ready()) {
+          EXPECT_EQ(buffer.Oldest().state, t - static_cast<int>(n));
+          EXPECT_DOUBLE_EQ(buffer.Discount(),
+                           std::pow(gamma, static_cast<double>(n)));
+          buffer.PopOldest();
+          window.pop_front();
+          ASSERT_NEAR(buffer.Return(), BruteForceReturn(window, gamma), 1e-12);
+        }
+        buffer.Push(t, t % 4);
+        EXPECT_LE(buffer.Size(), n);
+      }
+    }
+  }
+}
+
+TEST(NStepBuffer, SetGammaRebuildsReturn) {
+  Buffer buffer;
+  buffer.Reset(3, 1.0);
+  for (int t = 0; t < 3; ++t) {
+    buffer.Push(t, 0);
+    buffer.AddReward(t + 1.0);
+  }
+  EXPECT_DOUBLE_EQ(buffer.Return(), 6.0);
+  buffer.SetGamma(0.5);
+  EXPECT_DOUBLE_EQ(buffer.Return(), 1.0 + 0.5 * 2.0 + 0.25 * 3.0);
+  buffer.PopOldest();
+  EXPECT_DOUBLE_EQ(buffer.Return(), 2.0 + 0.5 * 3.0);
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <tabular_agents.h>
+
+using Agent = RLlib::TabularSarsaAgent<4, 2>;
+
+TEST(SarsaAgent, BatchedLanesAreIndependent) {
+  json config = {{"epsilon", 0.0},
+                 {"gamma", 0.0},
+                 {"training_mode", "q_learning"},
+                 {"model", {{"action_values", 0.0}}}};
+  Agent agent(Agent::ActionsList{0, 1}, config);
+
+  auto actions = agent.UpdateStates({0, 1, 2});
+  ASSERT_EQ(actions.size(), 3u);
+  // each lane rewards its own action, lanes 0 and 2 positively
+  agent.CollectRewards({1.0, -1.0, 2.0});
+  agent.UpdateStates({3, 3, 3});
+
+  const auto &q = agent.GetModel().GetActionValues();
+  EXPECT_DOUBLE_EQ(q[0][actions[0]], 1.0);
+  EXPECT_DOUBLE_EQ(q[1][actions[1]], -1.0);
+  EXPECT_DOUBLE_EQ(q[2][actions[2]], 2.0);
+  // no lane's update touches another action or state
+  for (int n = 0; n < 3; ++n) {
+    EXPECT_DOUBLE_EQ(q[n][1 - actions[n]], 0.0) << "lane " << n;
+  }
+  // state 3 was only bootstrapped from
+  EXPECT_DOUBLE_EQ(q[3][0], 0.0);
+  EXPECT_DOUBLE_EQ(q[3][1], 0.0);
+}
+
+namespace {
+
+// Tabular model whose bootstrap values come from a frozen copy of the table.
+struct TargetTabular : RLlib::Models::Tabular<4, 2> {
+  using Base = RLlib::Models::Tabular<4, 2>;
+  explicit TargetTabular(const json &config)
+      : Base(config), target_(config) {}
+
+  bool HasTargetNetwork() const { return true; }
+  const ResultsList &GetTargetActionValues(State state) {
+    return target_.GetActionValues(state);
+  }
+
+  Base target_;
+};
+
+// Records the raw transitions handed over by the agent.
+struct TransitionTabular : RLlib::Models::Tabular<4, 2> {
+  using Base = RLlib::Models::Tabular<4, 2>;
+  using Base::Base;
+
+  struct Transition {
+    int state, action;
+    double reward;
+    int next_state;
+    double discount;
+    bool done;
+  };
+
+  bool RecomputesTargets() const { return true; }
+  void UpdateTransition(State state, int action, double reward,
+                        State next_state, double discount, bool done) {
+    transitions.push_back({state, action, reward, next_state, discount, done});
+  }
+
+  std::vector<Transition> transitions;
+};
+
+}  // namespace
+
+TEST(SarsaAgent, BootstrapsFromTargetNetwork) {
+  using TargetAgent = RLlib::SarsaAgent<TargetTabular, int, double>;
+  json config = {{"epsilon", 0.0},
+                 {"gamma", 0.5},
+                 {"training_mode", "q_learning"},
+                 {"model", {{"action_values", 0.0}}}};
+  TargetAgent agent(TargetAgent::ActionsList{0, 1}, config);
+  agent.GetModel().target_.Update(1, 0, 10.0);  // target Q(1, 0) = 10
+
+  agent.UpdateState(0);
+  agent.CollectReward(1.0);
+  agent.UpdateState(1);
+  // 1 + 0.5 * max target Q(1, .); the online table still holds zeros
+  EXPECT_DOUBLE_EQ(agent.GetModel().GetActionValue(0, 0), 6.0);
+}
+
+TEST(SarsaAgent, HandsRawTransitionsToModel) {
+  using TransitionAgent = RLlib::SarsaAgent<TransitionTabular, int, double>;
+  json config = {{"epsilon", 0.0},
+                 {"gamma", 0.5},
+                 {"training_mode", "q_learning"},
+                 {"model", {{"action_values", 0.0}}}};
+  TransitionAgent agent(TransitionAgent::ActionsList{0, 1}, config);
+
+  agent.UpdateState(0);
+  agent.CollectReward(1.0);
+  agent.UpdateState(1);
+  agent.CollectReward(2.0);
+  agent.UpdateState(2);
+
+  const auto &transitions = agent.GetModel().transitions;
+  ASSERT_EQ(transitions.size(), 2u);
+  EXPECT_EQ(transitions[0].state, 0);
+  EXPECT_EQ(transitions[0].action, 0);
+  EXPECT_DOUBLE_EQ(transitions[0].reward, 1.0);
+  EXPECT_EQ(transitions[0].next_state, 1);
+  EXPECT_DOUBLE_EQ(transitions[0].discount, 0.5);
+  EXPECT_FALSE(transitions[0].done);
+  EXPECT_EQ(transitions[1].state, 1);
+  EXPECT_DOUBLE_EQ(transitions[1].reward, 2.0);
+  EXPECT_EQ(transitions[1].next_state, 2);
+  // the model bootstraps itself; the table never sees a TD target
+  EXPECT_DOUBLE_EQ(agent.GetModel().GetActionValue(0, 0), 0.0);
+
+  // its max targets would silently override any other mode
+  for (const char *mode : {"on_policy", "expected_sarsa", "double_q"}) {
+    config["training_mode"] = mode;
+    EXPECT_THROW(TransitionAgent(TransitionAgent::ActionsList{0, 1}, config),
+                 std::runtime_error)
+        << mode;
+  }
+}
+
+TEST(SarsaAgent, ExpectedSarsaAveragesOverEpsilonGreedyPolicy) {
+  json config = {{"epsilon", 0.2},
+                 {"gamma", 0.5},
+                 {"seed", 1},
+                 {"training_mode", "expected_sarsa"},
+                 {"model", {{"action_values", 0.0}}}};
+  Agent agent(Agent::ActionsList{0, 1}, config);
+  agent.GetModel().Update(1, 0, 10.0);
+
+  agent.UpdateState(0);
+  agent.CollectReward(1.0);
+  agent.UpdateState(1);
+  // 1 + 0.5 * (0.8 * 10 + 0.2 * 0), on whichever action was taken in 0
+  const auto &model = agent.GetModel();
+  EXPECT_DOUBLE_EQ(model.GetActionValue(0, 0) + model.GetActionValue(0, 1),
+                   5.0);
+}
+
+TEST(SarsaAgent, DoubleQEvaluatesGreedyActionWithOtherEstimate) {
+  json config = {{"epsilon", 0.0},
+                 {"gamma", 0.5},
+                 {"training_mode", "double_q"},
+                 {"model", {{"action_values", 0.0}}}};
+  Agent agent(Agent::ActionsList{0, 1}, config);
+  ASSERT_NE(agent.GetSecondModel(), nullptr);
+  auto &first = agent.GetModel();
+  auto &second = *agent.GetSecondModel();
+  first.Update(1, 0, 10.0);
+  second.Update(1, 1, 4.0);
+
+  agent.UpdateState(0);
+  agent.CollectReward(1.0);
+  agent.UpdateState(1);
+  // each estimate's greedy action in 1 is worth 0 to the other one, so the
+  // target is the bare reward, and only one estimate learns from it
+  const double first_q = first.GetActionValue(0, 0);
+  const double second_q = second.GetActionValue(0, 0);
+  EXPECT_DOUBLE_EQ(first_q + second_q, 1.0);
+  EXPECT_DOUBLE_EQ(first_q * second_q, 0.0);
+}
+
+TEST(SarsaAgent, SwitchingModesKeepsSettingsConsistent) {
+  json config = {{"epsilon", 0.0},
+                 {"gamma", 0.5},
+                 {"training_mode", "double_q"},
+                 {"model", {{"action_values", 0.0}}}};
+  Agent agent(Agent::ActionsList{0, 1}, config);
+  agent.GetSecondModel()->Update(0, 1, 4.0);
+  agent.SetTrainingMode(RLlib::SarsaTrainingMode::kQLearning);
+  // the stale second estimate no longer steers acting
+  EXPECT_EQ(agent.GetSecondModel(), nullptr);
+  EXPECT_EQ(agent.UpdateState(0), 0);
+
+  config["training_mode"] = "q_learning";
+  config["model"]["eligibility_traces"] = {{"lambda", 0.5}};
+  Agent traced(Agent::ActionsList{0, 1}, config);
+  EXPECT_THROW(traced.SetTrainingMode(RLlib::SarsaTrainingMode::kDoubleQ),
+               std::runtime_error);
+  EXPECT_EQ(traced.GetSecondModel(), nullptr);
+  // traces take one-step TD errors only
+  EXPECT_THROW(traced.SetSteps(3), std::runtime_error);
+  traced.SetSteps(1);
+}
+
+TEST(SarsaAgent, EligibilityTracesPropagateRewardBack) {
+  json config = {{"epsilon", 0.0},
+                 {"gamma", 1.0},
+                 {"training_mode", "q_learning"},
+                 {"model",
+                  {{"action_values", 0.0},
+                   {"eligibility_traces", {{"lambda", 1.0}}}}}};
+  Agent agent(Agent::ActionsList{0, 1}, config);
+
+  agent.UpdateState(0);
+  agent.CollectReward(0.0);
+  agent.UpdateState(1);
+  agent.CollectReward(1.0);
+  agent.UpdateState(2);
+  // the reward for leaving 1 also reaches the greedy step out of 0
+  EXPECT_DOUBLE_EQ(agent.GetModel().GetActionValue(1, 0), 1.0);
+  EXPECT_DOUBLE_EQ(agent.GetModel().GetActionValue(0, 0), 1.0);
+
+  Agent lanes(Agent::ActionsList{0, 1}, config);
+  EXPECT_THROW(lanes.UpdateStates({0, 1}), std::runtime_error);
+}
+
+TEST(SarsaAgent, NStepUpdatesEveryStepWithSlidingWindow) {
+  json config = {{"epsilon", 0.0},
+                 {"gamma", 0.5},
+                 {"steps", 2},
+                 {"training_mode", "q_learning"},
+                 {"model", {{"action_values", 0.0}}}};
+  Agent agent(Agent::ActionsList{0, 1}, config);
+  agent.GetModel().Update(2, 1, 8.0);
+
+  agent.UpdateState(0);
+  agent.CollectReward(1.0);
+  agent.UpdateState(1);
+  agent.CollectReward(2.0);
+  agent.UpdateState(2);
+  // 1 + 0.5 * 2 + 0.25 * max Q(2, .)
+  EXPECT_DOUBLE_EQ(agent.GetModel().GetActionValue(0, 0), 4.0);
+  EXPECT_DOUBLE_EQ(agent.GetModel().GetActionValue(1, 0), 0.0);
+
+  agent.CollectReward(4.0);
+  agent.UpdateState(3);
+  // the very next step already updates state 1: 2 + 0.5 * 4 + 0.25 * 0
+  EXPECT_DOUBLE_EQ(agent.GetModel().GetActionValue(1, 0), 4.0);
+}
@@ -0,0 +1,56 @@
+#include <checkpoint.h>
+#include <gtest/gtest.h>
+#include <models/linear.h>
+#include <models/tabular.h>
+
+#include <cstdio>
+#include <fstream>
+
+TEST(Checkpoint, LinearRoundTrip) {
+  using Model = RLlib::Models::SimpleLinearModel<3, 2>;
+  Model model(json{
+      {"weights", json{json{1.0, 2.0, 3.0}, json{-1.5, 0.25, 7.0}}}});
+  model.SaveCheckpoint("test_linear.ckpt");
+
+  Model loaded(json{{"weights", 0.0}});
+  loaded.LoadCheckpoint("test_linear.ckpt");
+  auto values = loaded.GetActionValues({1.0, 1.0, 1.0});
+  EXPECT_DOUBLE_EQ(values[0], 6.0);
+  EXPECT_DOUBLE_EQ(values[1], 5.75);
+  std::remove("test_linear.ckpt");
+}
+
+TEST(Checkpoint, TabularRoundTripAndShapeCheck) {
+  using Table = RLlib::Models::Tabular<4, 2>;
+  Table table(json{{"action_values", 0.5}});
+  table.Update(3, 1, 2.5);
+  table.SaveCheckpoint("test_tabular.ckpt");
+
+  Table loaded(json{{"action_values", 0.0}});
+  loaded.LoadCheckpoint("test_tabular.ckpt");
+  EXPECT_DOUBLE_EQ(loaded.GetActionValues(3)[1], 2.5);
+  EXPECT_DOUBLE_EQ(loaded.GetActionValues(0)[0], 0.5);
+
+  RLlib::Models::Tabular<5, 2> wrong_shape(json{{"action_values", 0.0}});
+  EXPECT_THROW(wrong_shape.LoadCheckpoint("test_tabular.ckpt"),
+               std::runtime_error);
+  std::remove("test_tabular.ckpt");
+}
+
+TEST(Checkpoint, DetectsCorruption) {
+  double data[4] = {1.0, 2.0, 3.0, 4.0};
+  RLlib::Checkpoint::Save("test_corrupt.ckpt", 2, 2, data);
+  {
+    std::fstream f("test_corrupt.ckpt",
+                   std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(sizeof(RLlib::Checkpoint::Header) + 3);
+    f.put('\x7f');
+  }
+  double out[4];
+  EXPECT_THROW(RLlib::Checkpoint::Load("test_corrupt.ckpt", 2, 2, out),
+               std::runtime_error);
+  float wrong_type[4];
+  EXPECT_THROW(RLlib::Checkpoint::Load("test_corrupt.ckpt", 2, 2, wrong_type),
+               std::runtime_error);
+  std::remove("test_corrupt.ckpt");
+}
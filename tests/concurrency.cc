@@ -0,0 +1,52 @@
+#include <concurrency.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+TEST(SpscQueue, FifoAcrossThreads) {
+  RLlib::SpscQueue<int> queue(16);
+  EXPECT_EQ(queue.Capacity(), 16u);
+  constexpr int kCount = 100000;
+  std::thread producer([&]() {
+    for (int i = 0; i < kCount; ++i) {
+      while (!queue.TryPush(i)) std::this_thread::yield();
+    }
+  });
+  int expected = 0;
+  int value;
+  while (expected < kCount) {
+    if (queue.TryPop(value)) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(SpscQueue, RejectsWhenFull) {
+  RLlib::SpscQueue<int> queue(2);
+  EXPECT_TRUE(queue.TryPush(1));
+  EXPECT_TRUE(queue.TryPush(2));
+  EXPECT_FALSE(queue.TryPush(3));
+  int value;
+  EXPECT_TRUE(queue.TryPop(value));
+  EXPECT_TRUE(queue.TryPush(3));
+}
+
+TEST(TripleBufferIndex, ReaderSeesLatestPublish) {
+  RLlib::TripleBufferIndex index;
+  int slots[3] = {0, 0, 0};
+  EXPECT_FALSE(index.Acquire());
+
+  slots[index.Back()] = 1;
+  index.Publish();
+  slots[index.Back()] = 2;
+  index.Publish();
+  EXPECT_TRUE(index.Acquire());
+  EXPECT_EQ(slots[index.Front()], 2);
+  EXPECT_NE(index.Front(), index.Back());
+  EXPECT_FALSE(index.Acquire());
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <grad_trace.h>
+#include <models/linear.h>
+
+#include <cstdio>
+#include <vector>
+
+TEST(GradTrace, RoundTripsAcrossArenaSwaps) {
+  const char *fname = "test_grad_trace.bin";
+  {
+    // a tiny arena forces many hand-offs to the writer thread
+    RLlib::GradTrace trace(json{{"file", fname}, {"every", 3},
+                                {"buffer_bytes", 256}});
+    for (int update = 0; update < 30; ++update) {
+      if (!trace.Sample()) continue;
+      auto r = trace.Reserve(2, 3, 4);
+      for (std::size_t i = 0; i < r.states.size(); ++i) r.states[i] = update;
+      r.actions[0] = 0;
+      r.actions[1] = 1;
+      r.last_q[0] = r.last_q[1] = -update;
+      r.new_q[0] = r.new_q[1] = 2 * update;
+      for (std::size_t i = 0; i < r.grad.size(); ++i) r.grad[i] = update + i;
+    }
+  }
+
+  std::vector<std::uint64_t> updates;
+  RLlib::ReadGradTrace(fname, [&](const RLlib::GradTrace::RecordHeader &h,
+                                  const RLlib::GradTrace::Record &r) {
+    const double u = static_cast<double>(h.update);
+    ASSERT_EQ(r.states.size(), 6u);
+    ASSERT_EQ(r.grad.size(), 4u);
+    EXPECT_EQ(r.states[5], u);
+    EXPECT_EQ(r.actions[1], 1.0);
+    EXPECT_EQ(r.last_q[0], -u);
+    EXPECT_EQ(r.new_q[1], 2 * u);
+    EXPECT_EQ(r.grad[3], u + 3);
+    updates.push_back(h.update);
+  });
+  ASSERT_EQ(updates.size(), 10u);
+  for (std::size_t k = 0; k < updates.size(); ++k) {
+    EXPECT_EQ(updates[k], 3 * k);
+  }
+  std::remove(fname);
+}
+
+TEST(GradTrace, LinearModelRecordsTheUpdatedRow) {
+  const char *fname = "test_grad_trace_linear.bin";
+  using Model = RLlib::Models::SimpleLinearModel<3, 2>;
+  {
+    Model model(json{{"weights", 0.0},
+                     {"learning_rate", 0.5},
+                     {"save_grad", {{"file", fname}}}});
+    model.Update(Model::State{1.0, 2.0, 3.0}, 1, 2.0);
+    // a copy keeps the weights but does not trace into the same file
+    Model copy = model;
+    EXPECT_DOUBLE_EQ(copy.GetActionValue(Model::State{1.0, 2.0, 3.0}, 1),
+                     model.GetActionValue(Model::State{1.0, 2.0, 3.0}, 1));
+    copy.Update(Model::State{1.0, 0.0, 0.0}, 0, 1.0);
+  }
+  int records = 0;
+  RLlib::ReadGradTrace(fname, [&](const RLlib::GradTrace::RecordHeader &,
+                                  const RLlib::GradTrace::Record &r) {
+    EXPECT_EQ(r.actions[0], 1.0);
+    EXPECT_EQ(r.last_q[0], 0.0);
+    EXPECT_EQ(r.new_q[0], 2.0);
+    const std::vector<double> grad(r.grad.begin(), r.grad.end());
+    EXPECT_EQ(grad, (std::vector<double>{0, 0, 0, -2, -4, -6}));
+    ++records;
+  });
+  EXPECT_EQ(records, 1);
+  std::remove(fname);
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <kernels.h>
+
+#include <vector>
+
+using namespace RLlib::Kernels;
+
+template <typename T>
+void CheckAllLevels(double tolerance) {
+  for (int n : {1, 3, 4, 7, 8, 15, 16, 17, 33, 67}) {
+    std::vector<T> a(3 * n), b(n), y(n), y_ref(n);
+    for (int j = 0; j < 3 * n; ++j) a[j] = static_cast<T>((j % 7) - 3) / 4;
+    for (int j = 0; j < n; ++j) b[j] = static_cast<T>((j % 5) + 1) / 2;
+
+    T dot_ref = detail::DotScalar(a.data(), b.data(), n);
+    T multi_ref[3];
+    detail::MultiDotScalar<3>(a.data(), n, b.data(), n, multi_ref);
+    for (int l = 0; l <= static_cast<int>(DetectedSimdLevel()); ++l) {
+      auto level = static_cast<SimdLevel>(l);
+      EXPECT_NEAR(Dot(level, a.data(), b.data(), n), dot_ref, tolerance);
+
+      T multi[3];
+      MultiDot<3>(level, a.data(), n, b.data(), n, multi);
+      for (int r = 0; r < 3; ++r) {
+        EXPECT_NEAR(multi[r], multi_ref[r], tolerance) << "n = " << n;
+      }
+
+      y.assign(b.begin(), b.end());
+      y_ref.assign(b.begin(), b.end());
+      Axpy(level, static_cast<T>(0.5), a.data(), y.data(), n);
+      detail::AxpyScalar(static_cast<T>(0.5), a.data(), y_ref.data(), n);
+      for (int j = 0; j < n; ++j) {
+        EXPECT_NEAR(y[j], y_ref[j], tolerance);
+      }
+    }
+  }
+}
+
+TEST(Kernels, DoubleMatchesScalar) { CheckAllLevels<double>(1e-12); }
+
+TEST(Kernels, FloatMatchesScalar) { CheckAllLevels<float>(1e-4); }
+
+TEST(Kernels, LevelNames) {
+  EXPECT_EQ(NameToSimdLevel("scalar"), SimdLevel::kScalar);
+  EXPECT_EQ(NameToSimdLevel("auto"), DetectedSimdLevel());
+  EXPECT_LE(NameToSimdLevel("avx512"), DetectedSimdLevel());
+  EXPECT_THROW(NameToSimdLevel("neon"), std::runtime_error);
+}
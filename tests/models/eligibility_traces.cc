@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <models/eligibility_traces.h>
+#include <models/linear.h>
+#include <models/tabular.h>
+
+using RLlib::Models::EligibilityTraces;
+
+TEST(EligibilityTraces, DecaysAndDropsBelowCutoff) {
+  EligibilityTraces traces(8, {{"lambda", 0.5}, {"cutoff", 0.1}});
+  traces.Visit(2);
+  traces.Visit(5, 2.0);
+  traces.Visit(2);  // accumulating
+  EXPECT_EQ(traces.ActiveCount(), 2u);
+  EXPECT_DOUBLE_EQ(traces.Trace(2), 2.0);
+
+  double seen = 0.0;
+  traces.Apply(0.25, [&](std::size_t, double trace) { seen += trace; });
+  EXPECT_DOUBLE_EQ(seen, 4.0);
+  EXPECT_DOUBLE_EQ(traces.Trace(5), 0.5);
+
+  traces.Visit(7);
+  traces.Apply(0.1, [](std::size_t, double) {});
+  // 0.05 for 2 and 5 is below the cutoff, 7 keeps exactly 0.1
+  EXPECT_EQ(traces.ActiveCount(), 1u);
+  EXPECT_DOUBLE_EQ(traces.Trace(2), 0.0);
+  EXPECT_DOUBLE_EQ(traces.Trace(7), 0.1);
+
+  traces.Clear();
+  EXPECT_EQ(traces.ActiveCount(), 0u);
+  EXPECT_DOUBLE_EQ(traces.Trace(7), 0.0);
+}
+
+TEST(EligibilityTraces, ReplacingResetsTrace) {
+  EligibilityTraces traces(4, {{"type", "replacing"}});
+  traces.Visit(1);
+  traces.Apply(0.5, [](std::size_t, double) {});
+  traces.Visit(1);
+  EXPECT_DOUBLE_EQ(traces.Trace(1), 1.0);
+}
+
+TEST(EligibilityTraces, TabularCreditsEarlierStates) {
+  RLlib::Models::Tabular<4, 2> model(
+      {{"action_values", 0.0}, {"eligibility_traces", {{"lambda", 0.5}}}});
+  model.SetLearningRate(0.5);
+  ASSERT_TRUE(model.HasTraces());
+
+  model.TraceUpdate(0, 0, 0.0, 1.0);
+  model.TraceUpdate(1, 1, 1.0, 1.0);
+  // error 1 at (1, 1); (0, 0) still carries a trace of 0.5
+  EXPECT_DOUBLE_EQ(model.GetActionValue(1, 1), 0.5);
+  EXPECT_DOUBLE_EQ(model.GetActionValue(0, 0), 0.25);
+  EXPECT_DOUBLE_EQ(model.GetActionValue(0, 1), 0.0);
+
+  model.ClearTraces();
+  model.TraceUpdate(2, 0, 2.0, 1.0);
+  EXPECT_DOUBLE_EQ(model.GetActionValue(2, 0), 1.0);
+  EXPECT_DOUBLE_EQ(model.GetActionValue(0, 0), 0.25);
+}
+
+TEST(EligibilityTraces, LinearTracesFollowFeatures) {
+  using LinearModel = RLlib::Models::SimpleLinearModel<3, 2>;
+  LinearModel model({{"weights", 0.0},
+                     {"learning_rate", 0.5},
+                     {"eligibility_traces", {{"lambda", 1.0}}}});
+
+  model.TraceUpdate({1.0, 0.0, 2.0}, 0, 0.0, 0.5);
+  model.TraceUpdate({0.0, 1.0, 0.0}, 1, 1.0, 0.5);
+  // action 0's row still has traces 0.5 * x = {0.5, 0, 1}
+  const auto *w = model.ParameterData();
+  EXPECT_DOUBLE_EQ(w[0], 0.25);
+  EXPECT_DOUBLE_EQ(w[1], 0.0);
+  EXPECT_DOUBLE_EQ(w[2], 0.5);
+  EXPECT_DOUBLE_EQ(w[4], 0.5);
+}
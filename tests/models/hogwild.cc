@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <models/hogwild.h>
+#include <tabular_agents.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using RLlib::Models::HogwildLinearModel;
+using RLlib::Models::HogwildTabular;
+
+TEST(Hogwild, CopiesShareParameters) {
+  HogwildLinearModel<3, 2> model(json{{"weights", 0.0}});
+  HogwildLinearModel<3, 2> copy = model;
+  copy.SetLearningRate(0.5);
+  copy.Update({1.0, 0.0, 2.0}, 1, 2.0);
+  EXPECT_EQ(model.Sharers(), 2);
+  EXPECT_DOUBLE_EQ(model.GetActionValue({1.0, 0.0, 0.0}, 1), 1.0);
+  EXPECT_DOUBLE_EQ(model.GetActionValues({0.0, 0.0, 1.0})[1], 2.0);
+  EXPECT_DOUBLE_EQ(model.GetActionValues({1.0, 1.0, 1.0})[0], 0.0);
+}
+
+TEST(Hogwild, AgentsShareOneModel) {
+  using Agent = RLlib::SarsaAgent<HogwildTabular<4, 2>, int, double>;
+  const json config = {{"epsilon", 0.0},
+                       {"gamma", 0.0},
+                       {"model", {{"action_values", 0.0}}}};
+  HogwildTabular<4, 2> model(config["model"]);
+  Agent first({0, 1}, config, model);
+  Agent second({0, 1}, config, model);
+  EXPECT_EQ(model.Sharers(), 3);
+
+  first.UpdateState(2);
+  first.CollectReward(1.0);
+  first.UpdateState(3);
+  // with learning rate 1 and gamma 0 the first step's value is its reward
+  const auto &values = second.GetModel().GetActionValues(2);
+  EXPECT_DOUBLE_EQ(std::max(values[0], values[1]), 1.0);
+  EXPECT_DOUBLE_EQ(values[0] + values[1], 1.0);
+}
+
+// Threads updating disjoint entries must end exactly where serial updates
+// would, in both modes.
+template <typename TModel>
+void CheckDisjointUpdates(TModel &model, int threads, int states) {
+  constexpr int kUpdates = 2000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&model, t, threads, states]() {
+      TModel local = model;
+      local.SetLearningRate(0.5);
+      for (int i = 0; i < kUpdates; ++i) {
+        for (int s = t; s < states; s += threads) {
+          local.Update(s, i % 2, static_cast<double>(s));
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) worker.join();
+  for (int s = 0; s < states; ++s) {
+    EXPECT_DOUBLE_EQ(model.GetActionValue(s, 0), static_cast<double>(s));
+    EXPECT_DOUBLE_EQ(model.GetActionValue(s, 1), static_cast<double>(s));
+  }
+}
+
+TEST(Hogwild, TabularDisjointUpdates) {
+  for (const char *mode : RLlib::Models::HogwildModeNames) {
+    HogwildTabular<64, 2> model(
+        json{{"action_values", 0.0}, {"hogwild", mode}, {"stripes", 4}});
+    CheckDisjointUpdates(model, 4, 64);
+  }
+}
+
+// Concurrent updates of the same weights may lose some steps in atomic mode
+// but still converge to a consistent target.
+TEST(Hogwild, LinearSharedRowsConverge) {
+  for (const char *mode : RLlib::Models::HogwildModeNames) {
+    using Model = HogwildLinearModel<16, 2>;
+    Model model(json{{"weights", 0.0}, {"hogwild", mode}});
+    ASSERT_EQ(model.Mode(), RLlib::Models::NameToHogwildMode(mode));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+      workers.emplace_back([&model, t]() {
+        Model local = model;
+        local.SetLearningRate(0.1);
+        for (int i = 0; i < 20000; ++i) {
+          Model::State x{};
+          x[(i + t) % 16] = 1.0;
+          local.Update(x, i % 2, (i % 2) ? -1.0 : 1.0);
+        }
+      });
+    }
+    for (auto &worker : workers) worker.join();
+    for (int j = 0; j < 16; ++j) {
+      Model::State x{};
+      x[j] = 1.0;
+      EXPECT_NEAR(model.GetActionValue(x, 0), 1.0, 1e-6) << mode;
+      EXPECT_NEAR(model.GetActionValue(x, 1), -1.0, 1e-6) << mode;
+    }
+  }
+}
+
+TEST(Hogwild, StripedLocksHashKeys) {
+  RLlib::StripedLocks locks(4);
+  EXPECT_EQ(locks.Size(), 4u);
+  EXPECT_EQ(&locks.For(1), &locks.For(5));
+  EXPECT_NE(&locks.For(1), &locks.For(2));
+  std::lock_guard<RLlib::SpinLock> guard(locks.For(3));
+  EXPECT_FALSE(locks.For(7).try_lock());
+  EXPECT_TRUE(locks.For(0).try_lock());
+  locks.For(0).unlock();
+  EXPECT_THROW(RLlib::StripedLocks(0), std::runtime_error);
+}
@@ -20,6 +20,7 @@ TEST(LinearModel, Forward) {
   auto results = model2.GetActionValues({1, 2, 3, 1});
   EXPECT_DOUBLE_EQ(results[0], 18.0);
   EXPECT_DOUBLE_EQ(results[1], -16.0);
+  EXPECT_DOUBLE_EQ(model2.GetActionValue({1, 2, 3, 1}, 1), -16.0);
 }
 
 TEST(LinearModel, Backward) {
@@ -36,4 +37,41 @@ TEST(LinearModel, Backward) {
   auto results = model.GetActionValues({1, 1, 2, 1});
   EXPECT_DOUBLE_EQ(results[0], -(11 * 1 + 10 * 1 + 21 * 2 + 8 * 1));
   EXPECT_DOUBLE_EQ(results[1], 1 * 1 - 2 * 1 - 3 * 2 - 4 * 1);
-}
\ No newline at end of file
+}
+
+TEST(LinearModel, FloatMatchesDouble) {
+  using FloatModel = RLlib::Models::SimpleLinearModel<16, 3, float>;
+  static_assert(std::is_same_v<FloatModel::Weight, float>);
+  static_assert(std::is_same_v<
+                RLlib::Models::SimpleLinearModel<16, 3, int>::Weight, double>);
+  using DoubleModel = RLlib::Models::SimpleLinearModel<16, 3>;
+
+  const json config = {{"weights", 0.0}, {"learning_rate", 0.01}};
+  FloatModel float_model(config);
+  DoubleModel double_model(config);
+
+  rng_util::seed(3);
+  for (int step = 0; step < 2000; ++step) {
+    FloatModel::State xf;
+    DoubleModel::State xd;
+    for (int j = 0; j < 16; ++j) {
+      xd[j] = rng_util::uniform01() - 0.5;
+      xf[j] = static_cast<float>(xd[j]);
+    }
+    const int action = step % 3;
+    // a fixed linear target per action
+    const double target = (action + 1) * (xd[0] - 2.0 * xd[5] + xd[15]);
+    float_model.Update(xf, action, target);
+    double_model.Update(xd, action, target);
+
+    const auto &qf = float_model.GetActionValues(xf);
+    const auto &qd = double_model.GetActionValues(xd);
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_NEAR(qf[i], qd[i], 1e-4) << "step " << step;
+    }
+  }
+  for (int j = 0; j < 3 * 16; ++j) {
+    EXPECT_NEAR(float_model.ParameterData()[j],
+                double_model.ParameterData()[j], 1e-4);
+  }
+}
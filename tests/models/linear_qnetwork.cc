@@ -0,0 +1,176 @@
+#include <grad_trace.h>
+#include <gtest/gtest.h>
+#include <models/off_policy_replay.h>
+#include <models/torch/linear.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using RLlib::Models::LinearQNetwork;
+
+// 13 features: more than one vector of either width, with a scalar tail
+constexpr int kFeatures = 13;
+constexpr int kActions = 3;
+
+// Random [kActions][kFeatures] weights, exact in float too.
+json RandomWeights(int seed) {
+  rng_util::seed(seed);
+  json weights = json::array();
+  for (int i = 0; i < kActions; ++i) {
+    json row = json::array();
+    for (int j = 0; j < kFeatures; ++j) {
+      row.push_back(static_cast<float>(rng_util::uniform01() - 0.5));
+    }
+    weights.push_back(row);
+  }
+  return weights;
+}
+
+template <typename TNet>
+std::vector<typename TNet::State> RandomStates(int count) {
+  using Feature = typename TNet::Feature;
+  std::vector<typename TNet::State> states(count);
+  for (auto &x : states) {
+    for (auto &v : x) {
+      v = static_cast<Feature>(2.0 * rng_util::uniform01() - 1.0);
+    }
+  }
+  return states;
+}
+
+std::array<double, kFeatures> ToDouble(const std::array<float, kFeatures> &x) {
+  std::array<double, kFeatures> out;
+  std::copy(x.begin(), x.end(), out.begin());
+  return out;
+}
+
+template <typename TNet>
+void ExpectNativeMatchesTorch(double tolerance) {
+  const json weights = RandomWeights(5);
+  TNet native(json{{"weights", weights}});
+  TNet reference(json{{"weights", weights}, {"native_inference", false}});
+  ASSERT_TRUE(native.NativeInference());
+  ASSERT_FALSE(reference.NativeInference());
+
+  const auto states = RandomStates<TNet>(17);
+  for (const auto &x : states) {
+    const auto expected = reference.GetActionValues(x);
+    const auto &q = native.GetActionValues(x);
+    for (int a = 0; a < kActions; ++a) {
+      EXPECT_NEAR(q[a], expected[a], tolerance);
+    }
+  }
+
+  const auto batch = native.GetBatchActionValues(states);
+  const auto &expected = reference.GetBatchActionValues(states);
+  ASSERT_EQ(batch.size(), states.size());
+  for (std::size_t n = 0; n < states.size(); ++n) {
+    for (int a = 0; a < kActions; ++a) {
+      EXPECT_NEAR(batch[n][a], expected[n][a], tolerance) << "state " << n;
+    }
+  }
+}
+
+TEST(LinearQNetwork, NativeInferenceMatchesTorchDouble) {
+  ExpectNativeMatchesTorch<LinearQNetwork<kFeatures, kActions>>(1e-12);
+}
+
+TEST(LinearQNetwork, NativeInferenceMatchesTorchFloat) {
+  ExpectNativeMatchesTorch<LinearQNetwork<kFeatures, kActions, float>>(1e-5);
+}
+
+TEST(LinearQNetwork, FloatForwardMatchesDouble) {
+  const json config = {{"weights", RandomWeights(6)},
+                       {"native_inference", false}};
+  LinearQNetwork<kFeatures, kActions, float> float_net(config);
+  LinearQNetwork<kFeatures, kActions> double_net(config);
+
+  const auto states = RandomStates<decltype(float_net)>(17);
+  for (const auto &xf : states) {
+    const auto xd = ToDouble(xf);
+    const auto q = float_net.GetActionValues(xf);
+    const auto &expected = double_net.GetActionValues(xd);
+    for (int a = 0; a < kActions; ++a) {
+      EXPECT_NEAR(q[a], expected[a], 1e-5);
+    }
+  }
+}
+
+// The per-minibatch loss 0.5 * mean((Q(s, a) - y)^2) and its gradient, read
+// back from the learner's gradient trace.
+struct MinibatchLoss {
+  double loss;
+  std::vector<double> grad;
+};
+
+std::vector<MinibatchLoss> ReadLosses(const char *fname) {
+  std::vector<MinibatchLoss> losses;
+  RLlib::ReadGradTrace(fname, [&](const RLlib::GradTrace::RecordHeader &,
+                                  const RLlib::GradTrace::Record &r) {
+    double loss = 0.0;
+    for (std::size_t n = 0; n < r.last_q.size(); ++n) {
+      const double diff = r.last_q[n] - r.new_q[n];
+      loss += 0.5 * diff * diff / r.last_q.size();
+    }
+    losses.push_back({loss, std::vector<double>(r.grad.begin(), r.grad.end())});
+  });
+  std::remove(fname);
+  return losses;
+}
+
+TEST(LinearQNetwork, FloatLearnerMatchesDouble) {
+  using FloatLearner =
+      RLlib::Models::OffPolicyReplayLinearModel<kFeatures, kActions, float>;
+  using DoubleLearner =
+      RLlib::Models::OffPolicyReplayLinearModel<kFeatures, kActions, double>;
+  const char *float_trace = "test_linear_qnetwork_float.bin";
+  const char *double_trace = "test_linear_qnetwork_double.bin";
+
+  // the minibatch is the whole buffer, so both learners train on the same
+  // rows whatever order their samplers draw them in
+  json config = {{"weights", RandomWeights(7)},
+                 {"learning_rate", 0.05},
+                 {"optimizer", {{"type", "sgd"}}},
+                 {"replay_capacity", 4},
+                 {"batch_size", 4}};
+  config["save_grad"] = {{"file", float_trace}};
+  {
+    FloatLearner float_learner(config);
+    config["save_grad"] = {{"file", double_trace}};
+    DoubleLearner double_learner(config);
+
+    const auto states = RandomStates<FloatLearner::Network>(40);
+    for (std::size_t step = 0; step < states.size(); ++step) {
+      const auto &xf = states[step];
+      const auto xd = ToDouble(xf);
+      const int action = static_cast<int>(step % kActions);
+      const double target = std::sin(0.3 * static_cast<double>(step));
+      float_learner.Update(xf, action, target);
+      double_learner.Update(xd, action, target);
+
+      const auto q = float_learner.GetActionValues(xf);
+      const auto &expected = double_learner.GetActionValues(xd);
+      for (int a = 0; a < kActions; ++a) {
+        ASSERT_NEAR(q[a], expected[a], 1e-4) << "step " << step;
+      }
+    }
+  }
+
+  const auto float_losses = ReadLosses(float_trace);
+  const auto double_losses = ReadLosses(double_trace);
+  ASSERT_EQ(float_losses.size(), 37u);
+  ASSERT_EQ(double_losses.size(), float_losses.size());
+  for (std::size_t k = 0; k < float_losses.size(); ++k) {
+    EXPECT_NEAR(float_losses[k].loss, double_losses[k].loss,
+                1e-4 * std::max(1.0, double_losses[k].loss))
+        << "minibatch " << k;
+    ASSERT_EQ(float_losses[k].grad.size(),
+              static_cast<std::size_t>(kActions * kFeatures));
+    for (std::size_t i = 0; i < float_losses[k].grad.size(); ++i) {
+      EXPECT_NEAR(float_losses[k].grad[i], double_losses[k].grad[i], 1e-4)
+          << "minibatch " << k << " weight " << i;
+    }
+  }
+}
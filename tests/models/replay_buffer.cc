@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <models/replay_buffer.h>
+#include <random_generator.h>
+
+#include <cmath>
+#include <vector>
+
+using RLlib::Models::ColumnarReplayBuffer;
+
+template <typename TBuffer>
+std::vector<typename TBuffer::State> PushRandom(TBuffer &buffer, int count) {
+  using Feature = typename TBuffer::Feature;
+  std::vector<typename TBuffer::State> states(count);
+  for (int n = 0; n < count; ++n) {
+    for (auto &v : states[n]) {
+      // magnitudes from 1e-4 to 1e2
+      v = static_cast<Feature>((rng_util::uniform01() - 0.5) *
+                               std::pow(10.0, n % 7 - 3));
+    }
+    buffer.Push(states[n], n % 3, 0.5 * n);
+  }
+  return states;
+}
+
+template <typename TFeature>
+void ExpectGatherWithin(bool bf16_states, double relative_error) {
+  using Buffer = ColumnarReplayBuffer<11, TFeature>;
+  Buffer buffer(16, 4, /*pin_memory=*/false, /*store_transitions=*/false,
+                bf16_states);
+  EXPECT_EQ(buffer.Bf16States(), bf16_states);
+  rng_util::seed(11);
+  const auto states = PushRandom(buffer, 16);
+
+  const std::vector<std::size_t> indices = {3, 0, 15, 8};
+  buffer.Gather(indices);
+  const auto &S = buffer.BatchStates();
+  ASSERT_EQ(S.scalar_type(), torch::CppTypeToScalarType<TFeature>::value);
+  const auto acc = S.template accessor<TFeature, 2>();
+  const auto actions = buffer.BatchActions().template accessor<int64_t, 1>();
+  const auto targets = buffer.BatchTargets().template accessor<double, 1>();
+  for (std::size_t b = 0; b < indices.size(); ++b) {
+    const auto &x = states[indices[b]];
+    for (int j = 0; j < Buffer::kFeaturesDim; ++j) {
+      EXPECT_NEAR(acc[b][j], x[j], relative_error * std::abs(x[j]))
+          << "row " << indices[b] << " feature " << j;
+    }
+    EXPECT_EQ(actions[b], static_cast<int64_t>(indices[b] % 3));
+    EXPECT_DOUBLE_EQ(targets[b], 0.5 * indices[b]);
+  }
+}
+
+TEST(ColumnarReplayBuffer, GatherReturnsPushedRows) {
+  ExpectGatherWithin<float>(false, 0.0);
+  ExpectGatherWithin<double>(false, 0.0);
+}
+
+TEST(ColumnarReplayBuffer, Bf16StatesRoundToEightBits) {
+  // 8 significant bits: within one bf16 ulp of the pushed value
+  ExpectGatherWithin<float>(true, std::ldexp(1.0, -8));
+  ExpectGatherWithin<double>(true, std::ldexp(1.0, -8));
+}
+
+TEST(ColumnarReplayBuffer, Bf16StatesNeedFloatFeatures) {
+  EXPECT_THROW((ColumnarReplayBuffer<4, int>(8, 2, false, false, true)),
+               std::runtime_error);
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include <models/replay_sampler.h>
+
+#include <random>
+#include <set>
+
+using RLlib::Models::MinibatchSampler;
+
+TEST(MinibatchSampler, WithoutReplacementIsDistinct) {
+  MinibatchSampler sampler(false, 32);
+  std::minstd_rand rng(7);
+  for (int trial = 0; trial < 100; ++trial) {
+    const auto &indices = sampler.Sample(40, 32, rng);
+    ASSERT_EQ(indices.size(), 32u);
+    std::set<std::size_t> unique(indices.begin(), indices.end());
+    EXPECT_EQ(unique.size(), 32u);
+    EXPECT_LT(*unique.rbegin(), 40u);
+  }
+  const auto &all = sampler.Sample(5, 5, rng);
+  EXPECT_EQ(std::set<std::size_t>(all.begin(), all.end()).size(), 5u);
+  EXPECT_THROW(sampler.Sample(4, 5, rng), std::runtime_error);
+}
+
+TEST(MinibatchSampler, WithReplacementCoversRange) {
+  MinibatchSampler sampler(true);
+  std::minstd_rand rng(7);
+  std::set<std::size_t> seen;
+  for (int trial = 0; trial < 100; ++trial) {
+    for (auto idx : sampler.Sample(8, 16, rng)) {
+      EXPECT_LT(idx, 8u);
+      seen.insert(idx);
+    }
+  }
+  EXPECT_EQ(seen.size(), 8u);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <linear_agents.h>
+#include <models/linear.h>
+#include <models/sparse_features.h>
+#include <models/sparse_linear.h>
+
+#include <algorithm>
+#include <set>
+
+using RLlib::Models::FeatureHasher;
+using RLlib::Models::SparseLinearModel;
+using RLlib::Models::SparseState;
+using RLlib::Models::TileCoder;
+
+TEST(SparseLinear, MatchesDenseModel) {
+  using Sparse = SparseLinearModel<8, 3, 4>;
+  using Dense = RLlib::Models::SimpleLinearModel<8, 3>;
+  Sparse sparse(json{{"weights", 0.5}, {"learning_rate", 0.1}});
+  Dense dense(json{{"weights", 0.5}, {"learning_rate", 0.1}});
+
+  for (int step = 0; step < 50; ++step) {
+    Sparse::State x;
+    Dense::State d{};
+    for (int k = 0; k < 3; ++k) {
+      const auto index = static_cast<std::uint32_t>((step * 3 + k * 5) % 8);
+      const double value = 0.25 * (k + 1);
+      x.Add(index, value);
+      d[index] += value;
+    }
+    const int action = step % 3;
+    sparse.Update(x, action, 1.0 - action);
+    dense.Update(d, action, 1.0 - action);
+    for (int a = 0; a < 3; ++a) {
+      ASSERT_NEAR(sparse.GetActionValues(x)[a], dense.GetActionValues(d)[a],
+                  1e-12);
+    }
+  }
+}
+
+TEST(SparseLinear, RejectsOutOfRangeIndex) {
+  SparseLinearModel<4, 2, 2> model(json{{"weights", 0.0}});
+  SparseState<2> x;
+  x.Add(4, 1.0);
+  EXPECT_THROW(model.GetActionValues(x), std::runtime_error);
+  x.Add(0, 1.0);
+  EXPECT_THROW(x.Add(1, 1.0), std::runtime_error);
+}
+
+TEST(TileCoder, OneTilePerTiling) {
+  TileCoder<2, 8> coder(
+      json{{"low", 0.0}, {"high", json{1.0, 2.0}}, {"tiles", 10}});
+  EXPECT_EQ(coder.TilesPerTiling(), 11u * 11u);
+  EXPECT_EQ(coder.Size(), 8u * 121u);
+
+  const auto x = coder.Encode({0.31, 1.5});
+  ASSERT_EQ(x.Size(), 8);
+  for (int k = 0; k < 8; ++k) {
+    // tiling k owns [k * 121, (k + 1) * 121)
+    EXPECT_EQ(x.features[k].index / 121, static_cast<std::uint32_t>(k));
+    EXPECT_DOUBLE_EQ(x.features[k].value, 1.0);
+  }
+
+  // nearby points share most tiles, distant ones none
+  auto shared = [&](const TileCoder<2, 8>::Observation &y) {
+    const auto z = coder.Encode(y);
+    int n = 0;
+    for (int k = 0; k < 8; ++k) n += x.features[k].index == z.features[k].index;
+    return n;
+  };
+  EXPECT_EQ(shared({0.31, 1.5}), 8);
+  EXPECT_GE(shared({0.32, 1.5}), 6);
+  EXPECT_EQ(shared({0.9, 0.2}), 0);
+  // clipped to the box
+  EXPECT_EQ(coder.Encode({-5.0, 9.0}).features[0].index,
+            coder.Encode({0.0, 2.0}).features[0].index);
+}
+
+TEST(TileCoder, HashedIndicesStayInRange) {
+  using Coder = TileCoder<6, 4>;
+  Coder coder(json{{"low", -1.0},
+                   {"high", 1.0},
+                   {"tiles", 1000},
+                   {"size", 1 << 16},
+                   {"seed", 3}});
+  EXPECT_TRUE(coder.Hashed());
+  std::set<std::uint32_t> seen;
+  for (int i = 0; i < 100; ++i) {
+    const double v = -1.0 + 0.02 * i;
+    for (const auto &f : coder.Encode({v, -v, v, v * v, 0.5, -0.5})) {
+      EXPECT_LT(f.index, 1u << 16);
+      seen.insert(f.index);
+    }
+  }
+  EXPECT_GT(seen.size(), 300u);
+  // 4 * 1001^6 tiles cannot be indexed densely
+  const json dense = {{"low", 0.0}, {"high", 1.0}, {"tiles", 1000}};
+  EXPECT_THROW(Coder{dense}, std::runtime_error);
+}
+
+TEST(FeatureHasher, DeterministicSignedBuckets) {
+  FeatureHasher<5> hasher(json{{"size", 64}, {"seed", 7}});
+  const auto x = hasher.Encode({1.0, 0.0, -2.0, 3.0, 0.5});
+  ASSERT_EQ(x.Size(), 4);  // the zero input is skipped
+  const auto y = hasher.Encode({2.0, 0.0, -4.0, 6.0, 1.0});
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_LT(x.features[i].index, 64u);
+    EXPECT_EQ(x.features[i].index, y.features[i].index);
+    EXPECT_DOUBLE_EQ(2.0 * x.features[i].value, y.features[i].value);
+  }
+  EXPECT_DOUBLE_EQ(std::abs(x.features[2].value), 3.0);
+
+  FeatureHasher<5> unsigned_hasher(
+      json{{"size", 64}, {"seed", 7}, {"signed", false}});
+  const auto z = unsigned_hasher.Encode({1.0, 0.0, -2.0, 3.0, 0.5});
+  EXPECT_DOUBLE_EQ(z.features[2].value, 3.0);
+
+  SparseState<6> keyed;
+  hasher.AddKey(keyed, 123456789, 1.0);
+  EXPECT_EQ(keyed.Size(), 1);
+  EXPECT_LT(keyed.features[0].index, 64u);
+}
+
+TEST(SparseLinear, AgentLearnsOnTileCodes) {
+  // a 1-d chain: moving right from the last cell pays 1. Q-learning is
+  // off-policy, so a uniformly random walk is enough to learn to go right.
+  using Agent = RLlib::SparseLinearSarsaAgent<4 * 11, 2, 4, int>;
+  TileCoder<1, 4> coder(json{{"low", 0.0}, {"high", 1.0}, {"tiles", 10}});
+  const json config = {{"epsilon", 1.0},
+                       {"gamma", 0.9},
+                       {"training_mode", "q_learning"},
+                       {"model", {{"weights", 0.0}, {"learning_rate", 0.05}}}};
+  Agent agent({-1, 1}, config);
+  rng_util::seed(1);
+  int cell = 0;
+  for (int step = 0; step < 20000; ++step) {
+    const int move = agent.UpdateState(coder.Encode({cell / 9.0}));
+    const int next = std::clamp(cell + move, 0, 9);
+    agent.CollectReward(cell == 9 && move == 1 ? 1.0 : 0.0);
+    cell = next;
+  }
+  auto &model = agent.GetModel();
+  for (int c = 0; c < 9; ++c) {
+    const auto &q = model.GetActionValues(coder.Encode({c / 9.0}));
+    EXPECT_GT(q[1], q[0]) << "cell " << c;
+  }
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <models/sparse_tabular.h>
+#include <models/tabular.h>
+
+#include <cstdio>
+#include <random>
+
+using SparseModel = RLlib::Models::SparseTabular<3>;
+
+TEST(SparseTabular, ReadsDefaultWithoutInserting) {
+  SparseModel model({{"action_values", 2.0}, {"learning_rate", 0.5}});
+  EXPECT_DOUBLE_EQ(model.GetActionValues(123456789)[1], 2.0);
+  EXPECT_EQ(model.Size(), 0u);
+
+  model.Update(123456789, 1, 4.0);
+  EXPECT_EQ(model.Size(), 1u);
+  EXPECT_DOUBLE_EQ(model.GetActionValue(123456789, 1), 3.0);
+  EXPECT_DOUBLE_EQ(model.GetActionValue(123456789, 0), 2.0);
+}
+
+TEST(SparseTabular, MatchesDenseTableThroughGrowth) {
+  constexpr int kStates = 5000;
+  RLlib::Models::Tabular<kStates, 3> dense(json{{"action_values", 0.0}});
+  SparseModel sparse({{"action_values", 0.0}, {"initial_capacity", 8}});
+  std::mt19937_64 rng(5);
+  std::uniform_int_distribution<int> state(0, kStates - 1);
+  std::uniform_int_distribution<int> action(0, 2);
+  for (int i = 0; i < 20000; ++i) {
+    const int s = state(rng);
+    const int a = action(rng);
+    const double target = 0.001 * i;
+    dense.Update(s, a, target);
+    sparse.Update(s, a, target);
+  }
+  EXPECT_LE(sparse.LoadFactor(), 0.5);
+  for (int s = 0; s < kStates; ++s) {
+    for (int a = 0; a < 3; ++a) {
+      ASSERT_DOUBLE_EQ(sparse.GetActionValue(s, a), dense.GetActionValue(s, a));
+    }
+  }
+}
+
+TEST(SparseTabular, CheckpointAndTextRoundTrip) {
+  SparseModel model(json{{"action_values", 0.0}});
+  for (std::uint64_t s : {7ull, 1ull << 40, 99ull}) {
+    model.Update(s, static_cast<int>(s % 3),
+                 0.25 * static_cast<double>(s % 8));
+  }
+  const char *ckpt = "sparse_tabular_test.ckpt";
+  const char *text = "sparse_tabular_test.txt";
+  model.SaveCheckpoint(ckpt);
+  model.OutputModel(text);
+
+  SparseModel from_ckpt(json{{"action_values", 0.0}});
+  from_ckpt.LoadCheckpoint(ckpt);
+  SparseModel from_text(json{{"action_values", 0.0}});
+  from_text.LoadModel(text);
+  for (const auto *loaded : {&from_ckpt, &from_text}) {
+    EXPECT_EQ(loaded->Size(), 3u);
+    model.ForEach([&](std::uint64_t s, const SparseModel::ResultsList &row) {
+      for (int a = 0; a < 3; ++a) {
+        EXPECT_DOUBLE_EQ(loaded->GetActionValue(s, a), row[a]);
+      }
+    });
+  }
+  std::remove(ckpt);
+  std::remove(text);
+}
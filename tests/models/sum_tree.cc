@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <models/replay_sampler.h>
+#include <models/sum_tree.h>
+
+#include <random>
+#include <vector>
+
+using RLlib::Models::PrioritizedSampler;
+using RLlib::Models::SumTree;
+
+TEST(SumTree, UpdateAndFind) {
+  SumTree tree(5);
+  tree.Update(0, 1.0);
+  tree.Update(1, 2.0);
+  tree.Update(2, 0.0);
+  tree.Update(3, 3.0);
+  tree.Update(4, 4.0);
+  EXPECT_DOUBLE_EQ(tree.Total(), 10.0);
+  EXPECT_DOUBLE_EQ(tree.Min(), 0.0);
+  EXPECT_EQ(tree.Find(0.5), 0u);
+  EXPECT_EQ(tree.Find(1.0), 1u);
+  EXPECT_EQ(tree.Find(2.99), 1u);
+  EXPECT_EQ(tree.Find(3.0), 3u);
+  EXPECT_EQ(tree.Find(6.0), 4u);
+  EXPECT_EQ(tree.Find(10.0), 4u);
+
+  tree.Update(4, 0.5);
+  EXPECT_DOUBLE_EQ(tree.Total(), 6.5);
+  EXPECT_EQ(tree.Find(6.2), 4u);
+}
+
+TEST(SumTree, BuildMatchesUpdates) {
+  const std::vector<double> priorities = {0.5, 2.0, 0.25, 3.0, 1.0, 4.0};
+  SumTree updated(7);
+  SumTree built(7);
+  updated.Update(6, 9.0);
+  built.Update(6, 9.0);  // past count: emptied by Build
+  for (std::size_t i = 0; i < priorities.size(); ++i) {
+    updated.Update(i, priorities[i]);
+  }
+  updated.Update(6, 0.0);
+  built.Build(priorities.data(), priorities.size());
+  EXPECT_DOUBLE_EQ(built.Total(), updated.Total());
+  EXPECT_DOUBLE_EQ(built.Min(), 0.25);
+  for (double prefix : {0.0, 0.6, 2.6, 5.0, 6.9, 10.6}) {
+    EXPECT_EQ(built.Find(prefix), updated.Find(prefix)) << prefix;
+  }
+  EXPECT_THROW(built.Build(priorities.data(), 8), std::runtime_error);
+}
+
+TEST(PrioritizedSampler, ProportionalFollowsPriorities) {
+  PrioritizedSampler sampler(4, json{{"alpha", 1.0}, {"beta", 1.0},
+                                     {"epsilon", 1e-12}});
+  for (std::size_t i = 0; i < 4; ++i) sampler.Add(i);
+  std::vector<std::size_t> all{0, 1, 2, 3};
+  std::vector<double> errors{1.0, 1.0, 2.0, 4.0};
+  sampler.UpdatePriorities(all, errors.data());
+
+  std::minstd_rand rng(3);
+  int counts[4] = {};
+  for (int trial = 0; trial < 2000; ++trial) {
+    for (auto idx : sampler.Sample(4, rng)) ++counts[idx];
+  }
+  EXPECT_NEAR(static_cast<double>(counts[3]) / counts[0], 4.0, 0.3);
+  EXPECT_NEAR(static_cast<double>(counts[2]) / counts[1], 2.0, 0.2);
+
+  const std::vector<double> expected{1.0, 1.0, 0.5, 0.25};
+  const auto &indices = sampler.Sample(8, rng);
+  const auto &weights = sampler.Weights();
+  for (std::size_t b = 0; b < indices.size(); ++b) {
+    EXPECT_NEAR(weights[b], expected[indices[b]], 1e-9);
+  }
+}
+
+TEST(PrioritizedSampler, RankOrdersByError) {
+  PrioritizedSampler sampler(3, json{{"mode", "rank"},
+                                     {"alpha", 1.0},
+                                     {"rank_sort_interval", 1}});
+  for (std::size_t i = 0; i < 3; ++i) sampler.Add(i);
+  std::vector<std::size_t> all{0, 1, 2};
+  std::vector<double> errors{0.1, 5.0, 1.0};
+  sampler.UpdatePriorities(all, errors.data());
+
+  std::minstd_rand rng(3);
+  sampler.Sample(1, rng);
+  EXPECT_DOUBLE_EQ(sampler.Tree().Get(1), 1.0);
+  EXPECT_DOUBLE_EQ(sampler.Tree().Get(2), 0.5);
+  EXPECT_DOUBLE_EQ(sampler.Tree().Get(0), 1.0 / 3.0);
+}
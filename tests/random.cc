@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 #include "random_generator.h"
 
+#include <cmath>
+#include <set>
+#include <thread>
+#include <vector>
+
 TEST(RandomGenerator, Uniform01Range) {
   for (int i = 0; i < 1000; ++i) {
     double v = rng_util::uniform01();
@@ -8,3 +13,112 @@ TEST(RandomGenerator, Uniform01Range) {
     EXPECT_LT(v, 1.0);
   }
 }
+
+TEST(RandomGenerator, SeedIsReproducible) {
+  rng_util::seed(42);
+  std::vector<double> first;
+  for (int i = 0; i < 16; ++i) first.push_back(rng_util::uniform01());
+  first.push_back(rng_util::normal());
+  rng_util::seed(42);
+  for (int i = 0; i < 16; ++i) EXPECT_EQ(rng_util::uniform01(), first[i]);
+  EXPECT_EQ(rng_util::normal(), first[16]);
+}
+
+TEST(RandomGenerator, StreamsAreIndependent) {
+  rng_util::seed(7);
+  auto a = rng_util::make_stream(0);
+  auto b = rng_util::make_stream(1);
+  auto c = rng_util::make_stream(1);
+  int equal = 0;
+  for (int i = 0; i < 64; ++i) {
+    auto va = a();
+    auto vb = b();
+    EXPECT_EQ(vb, c());
+    equal += va == vb;
+  }
+  EXPECT_EQ(equal, 0);
+
+  // worker threads draw from their own streams
+  std::vector<double> draws(4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&draws, t] {
+      rng_util::set_stream(t + 1);
+      draws[t] = rng_util::uniform01();
+    });
+  }
+  for (auto &th : threads) th.join();
+  EXPECT_EQ(std::set<double>(draws.begin(), draws.end()).size(), 4u);
+  EXPECT_EQ(draws[0], rng_util::to_unit(rng_util::make_stream(1)()));
+}
+
+TEST(RandomGenerator, ReservedStreamsAreSkipped) {
+  rng_util::seed(7);
+  rng_util::reserve_streams(4);
+  auto first = rng_util::new_stream();
+  EXPECT_EQ(first(), rng_util::make_stream(5)());
+  // never moves the counter back
+  rng_util::reserve_streams(2);
+  EXPECT_EQ(rng_util::new_stream()(), rng_util::make_stream(6)());
+}
+
+// Known-answer vectors from the Random123 distribution.
+TEST(RandomGenerator, PhiloxKnownAnswers) {
+  const uint32_t zero_ctr[4] = {0, 0, 0, 0}, zero_key[2] = {0, 0};
+  uint32_t out[4];
+  rng_util::Philox4x32::rounds(zero_ctr, zero_key, out);
+  EXPECT_EQ(out[0], 0x6627e8d5u);
+  EXPECT_EQ(out[1], 0xe169c58du);
+  EXPECT_EQ(out[2], 0xbc57ac4cu);
+  EXPECT_EQ(out[3], 0x9b00dbd8u);
+
+  const uint32_t pi_ctr[4] = {0x243f6a88u, 0x85a308d3u, 0x13198a2eu,
+                              0x03707344u};
+  const uint32_t pi_key[2] = {0xa4093822u, 0x299f31d0u};
+  rng_util::Philox4x32::rounds(pi_ctr, pi_key, out);
+  EXPECT_EQ(out[0], 0xd16cfe09u);
+  EXPECT_EQ(out[1], 0x94fdccebu);
+  EXPECT_EQ(out[2], 0x5001e420u);
+  EXPECT_EQ(out[3], 0x24126ea1u);
+}
+
+TEST(RandomGenerator, PhiloxRandomAccess) {
+  rng_util::Philox4x32 seq(123, 5);
+  std::vector<uint64_t> values;
+  for (int i = 0; i < 10; ++i) values.push_back(seq());
+  rng_util::Philox4x32 other(123, 5);
+  uint64_t block[2];
+  other.block(3, block);
+  EXPECT_EQ(block[0], values[6]);
+  EXPECT_EQ(block[1], values[7]);
+  other.seek(4);
+  EXPECT_EQ(other(), values[8]);
+  EXPECT_NE(rng_util::Philox4x32(123, 6)(), values[0]);
+}
+
+TEST(RandomGenerator, BatchedMoments) {
+  rng_util::Xoshiro256PlusPlus rng(1);
+  constexpr std::size_t kN = 200001;  // odd on purpose
+  std::vector<double> u(kN), z(kN);
+  rng_util::fill_uniform(rng, u.data(), kN);
+  rng_util::fill_normal(rng, z.data(), kN, 2.0, 3.0);
+  double su = 0.0, sz = 0.0, szz = 0.0;
+  for (std::size_t i = 0; i < kN; ++i) {
+    ASSERT_GE(u[i], 0.0);
+    ASSERT_LT(u[i], 1.0);
+    su += u[i];
+    sz += z[i];
+    szz += z[i] * z[i];
+  }
+  const double mean = sz / kN;
+  EXPECT_NEAR(su / kN, 0.5, 0.01);
+  EXPECT_NEAR(mean, 2.0, 0.03);
+  EXPECT_NEAR(std::sqrt(szz / kN - mean * mean), 3.0, 0.03);
+}
+
+TEST(RandomGenerator, UniformIntRange) {
+  rng_util::Xoshiro256PlusPlus rng(3);
+  std::vector<int> counts(3, 0);
+  for (int i = 0; i < 30000; ++i) ++counts[rng_util::uniform_int(rng, 3)];
+  for (int c : counts) EXPECT_NEAR(c, 10000, 400);
+}
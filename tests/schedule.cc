@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <schedule.h>
+
+#include <cmath>
+#include <numbers>
+
+using RLlib::Schedule;
+
+TEST(Schedule, Table) {
+  Schedule schedule(json{0.5, 0.25, 0.125});
+  EXPECT_DOUBLE_EQ(schedule.Value(0), 0.5);
+  EXPECT_DOUBLE_EQ(schedule.Value(2), 0.125);
+  EXPECT_DOUBLE_EQ(schedule.Value(100), 0.125);
+  EXPECT_TRUE(Schedule(json::array()).Empty());
+}
+
+TEST(Schedule, Formula) {
+  Schedule schedule(json("0.1 / (round + 1) + 0.01"));
+  for (int round = 0; round < 10; ++round) {
+    EXPECT_DOUBLE_EQ(schedule.Value(round), 0.1 / (round + 1) + 0.01);
+  }
+  // copies recompile against their own round variable
+  Schedule copy = schedule;
+  Schedule moved = std::move(schedule);
+  EXPECT_DOUBLE_EQ(copy.Value(4), 0.1 / 5 + 0.01);
+  EXPECT_DOUBLE_EQ(moved.Value(9), 0.1 / 10 + 0.01);
+  EXPECT_THROW(Schedule(json("0.1 / (round +")), std::runtime_error);
+}
+
+TEST(Schedule, Native) {
+  Schedule constant(json{{"type", "constant"}, {"value", 0.3}});
+  EXPECT_DOUBLE_EQ(constant.Value(1000), 0.3);
+
+  Schedule inverse_time(json{
+      {"type", "inverse_time"}, {"initial", 0.1}, {"decay", 1.0},
+      {"minimum", 0.01}});
+  EXPECT_DOUBLE_EQ(inverse_time.Value(3), 0.1 / 4 + 0.01);
+
+  Schedule exponential(json{
+      {"type", "exponential"}, {"initial", 1.0}, {"rate", 0.5},
+      {"minimum", 0.1}});
+  EXPECT_NEAR(exponential.Value(2), 0.25, 1e-12);
+  EXPECT_DOUBLE_EQ(exponential.Value(10), 0.1);
+
+  Schedule piecewise(json{{"type", "piecewise"},
+                          {"boundaries", json{10, 20}},
+                          {"values", json{1.0, 0.5, 0.1}}});
+  EXPECT_DOUBLE_EQ(piecewise.Value(9), 1.0);
+  EXPECT_DOUBLE_EQ(piecewise.Value(10), 0.5);
+  EXPECT_DOUBLE_EQ(piecewise.Value(25), 0.1);
+
+  Schedule cosine(json{{"type", "cosine"},
+                       {"initial", 1.0},
+                       {"minimum", 0.0},
+                       {"period", 100}});
+  EXPECT_DOUBLE_EQ(cosine.Value(0), 1.0);
+  EXPECT_NEAR(cosine.Value(50), 0.5, 1e-12);
+  EXPECT_NEAR(cosine.Value(200), 0.0, 1e-12);
+
+  EXPECT_THROW(Schedule(json{{"type", "linear"}}), std::runtime_error);
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <snapshot_writer.h>
+
+#include <cstdio>
+#include <vector>
+
+TEST(SnapshotWriter, RecordsEveryNthStep) {
+  const char *fname = "test_snapshots.snap";
+  std::vector<double> params(6);
+  {
+    // a single slot forces Push to wait for the writer thread
+    RLlib::SnapshotWriter<double> writer(
+        json{{"file", fname}, {"every", 10}, {"queue_capacity", 1}}, 2, 3);
+    for (std::uint64_t step = 0; step < 100; ++step) {
+      for (std::size_t i = 0; i < params.size(); ++i) {
+        params[i] = static_cast<double>(step * 10 + i);
+      }
+      if (writer.Due(step)) writer.Push(step, params.data());
+    }
+  }
+
+  std::vector<std::uint64_t> steps;
+  auto header = RLlib::ReadSnapshots<double>(
+      fname, [&](std::uint64_t step, std::span<const double> values) {
+        ASSERT_EQ(values.size(), 6u);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+          EXPECT_EQ(values[i], static_cast<double>(step * 10 + i));
+        }
+        steps.push_back(step);
+      });
+  EXPECT_EQ(header.rows, 2u);
+  EXPECT_EQ(header.cols, 3u);
+  ASSERT_EQ(steps.size(), 10u);
+  for (std::size_t k = 0; k < steps.size(); ++k) EXPECT_EQ(steps[k], 10 * k);
+  std::remove(fname);
+}
+
+TEST(SnapshotWriter, RejectsOtherFiles) {
+  const char *fname = "test_snapshots_bad.snap";
+  { std::ofstream(fname) << "not a snapshot"; }
+  EXPECT_THROW(RLlib::ReadSnapshots<double>(
+                   fname, [](std::uint64_t, std::span<const double>) {}),
+               std::runtime_error);
+  std::remove(fname);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <trajectory_recorder.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+struct Step {
+  double reward;
+  std::int32_t row;
+  std::int32_t col;
+  bool operator==(const Step &) const = default;
+};
+
+std::vector<Step> MakeSteps(int n) {
+  std::vector<Step> steps;
+  for (int i = 0; i < n; ++i) {
+    steps.push_back({i % 7 == 0 ? -1.5 : 0.25 * (i % 3), (i * 3) % 5 - 2,
+                     -(i % 6)});
+  }
+  return steps;
+}
+
+std::vector<Step> RoundTrip(const char *encoding, const char *fname,
+                            const std::vector<Step> &steps) {
+  {
+    RLlib::TrajectoryRecorder recorder(
+        json{{"file", fname}, {"chunk_steps", 100}, {"encoding", encoding}},
+        2);
+    for (const auto &s : steps) recorder.Record(s.reward, {s.row, s.col});
+    EXPECT_EQ(recorder.Steps(), steps.size());
+  }
+  std::vector<Step> read;
+  RLlib::ReadTrajectory(fname,
+                        [&](double reward, std::span<const std::int32_t> st) {
+                          read.push_back({reward, st[0], st[1]});
+                        });
+  return read;
+}
+
+}  // namespace
+
+TEST(TrajectoryRecorder, RawRoundTrip) {
+  const auto steps = MakeSteps(1050);  // ends with a partial chunk
+  EXPECT_EQ(RoundTrip("raw", "test_trajectory_raw.bin", steps), steps);
+  std::remove("test_trajectory_raw.bin");
+}
+
+TEST(TrajectoryRecorder, DeltaRoundTripIsSmaller) {
+  const auto steps = MakeSteps(1050);
+  EXPECT_EQ(RoundTrip("delta", "test_trajectory_delta.bin", steps), steps);
+  RoundTrip("raw", "test_trajectory_raw2.bin", steps);
+  EXPECT_LT(std::filesystem::file_size("test_trajectory_delta.bin"),
+            std::filesystem::file_size("test_trajectory_raw2.bin") / 2);
+  std::remove("test_trajectory_delta.bin");
+  std::remove("test_trajectory_raw2.bin");
+}
+
+TEST(TrajectoryRecorder, RejectsBadConfig) {
+  EXPECT_THROW(RLlib::TrajectoryRecorder(
+                   json{{"file", "test_trajectory_bad.bin"},
+                        {"encoding", "zstd"}},
+                   2),
+               std::runtime_error);
+}